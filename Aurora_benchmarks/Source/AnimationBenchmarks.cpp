@@ -0,0 +1,231 @@
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <SFML/Graphics/Texture.hpp>
+
+#include <Animation.h>
+#include <AnimationLibrary.h>
+#include <AnimationSystem.h>
+
+#include "Benchmarks.h"
+
+namespace au
+{
+	namespace bench
+	{
+		namespace
+		{
+			const sf::Time FrameTime(sf::seconds(1.f / 60.f));
+
+			/// <summary>Writes the data of a sprite sheet of one or several animations in TexturePacker's JSON (array) format</summary>
+			void writeAnimationFile(const std::string& filename, const std::vector<std::string>& sprite_files, unsigned frame_count)
+			{
+				std::ofstream file(filename);
+				file << "{\"frames\": [\n\n";
+				for (size_t animation = 0; animation < sprite_files.size(); ++animation) {
+					for (unsigned i = 1; i <= frame_count; ++i) {
+						const unsigned x = (i - 1) % 16 * 64, y = (i - 1) / 16 * 64;
+						const bool last = animation == sprite_files.size() - 1 && i == frame_count;
+						file << "{\n"
+						     << "\t\"filename\": \"" << sprite_files[animation] << i << ".png\",\n"
+						     << "\t\"frame\": {\"x\":" << x << ",\"y\":" << y << ",\"w\":64,\"h\":64},\n"
+						     << "\t\"rotated\": false,\n"
+						     << "\t\"trimmed\": false,\n"
+						     << "\t\"spriteSourceSize\": {\"x\":0,\"y\":0,\"w\":64,\"h\":64},\n"
+						     << "\t\"sourceSize\": {\"w\":64,\"h\":64},\n"
+						     << "\t\"pivot\": {\"x\":0.5,\"y\":0.5}\n"
+						     << (last ? "}" : "},") << '\n';
+					}
+				}
+				file << "],\n\"meta\": {\n\t\"image\": \"" << sprite_files.front() << ".png\"\n}\n}\n";
+			}
+		}
+
+		void registerAnimationBenchmarks(BenchmarkSuite& suite)
+		{
+			for (double frame_count : { 16.0, 128.0 }) {
+				suite.add("animation_parse", { { "frames", frame_count } }, [=](Benchmark& benchmark) {
+					const std::string filename("Aurora_benchmarks_animation.json");
+					writeAnimationFile(filename, { "Knight_Walk" }, static_cast<unsigned>(frame_count));
+
+					sf::Texture texture;
+					SpriteNode sprite(texture);
+					benchmark.measure([&]() {
+						Animation::Data data;
+						data.total_duration = sf::seconds(1.f);
+						data.repeat = true;
+						data.loopback = false;
+						Animation animation(filename, "Knight_Walk", &data, &sprite);
+					});
+					std::remove(filename.c_str());
+				});
+			}
+
+			for (double animation_count : { 8.0, 32.0 }) {
+				for (bool atlas : { false, true }) {
+					// 0: the file is parsed once per animation, 1: every animation is loaded from a single atlas
+					const BenchmarkSuite::Parameters parameters = { { "animations", animation_count }, { "atlas", atlas } };
+
+					suite.add("animation_load_sheet", parameters, [=](Benchmark& benchmark) {
+						const std::string filename("Aurora_benchmarks_animation.json");
+						std::vector<std::string> sprite_files;
+						for (size_t i = 0; i < static_cast<size_t>(animation_count); ++i)
+							sprite_files.push_back("Knight_Action" + std::to_string(i) + "_");
+						writeAnimationFile(filename, sprite_files, 32);
+
+						sf::Texture texture;
+						SpriteNode sprite(texture);
+						benchmark.measure([&]() {
+							AnimationAtlas animation_atlas;
+							if (atlas)
+								animation_atlas.loadFromFile(filename);
+							for (const std::string& sprite_file : sprite_files) {
+								Animation::Data data;
+								data.total_duration = sf::seconds(1.f);
+								data.repeat = true;
+								data.loopback = false;
+								if (atlas)
+									Animation(animation_atlas, sprite_file, &data, &sprite);
+								else
+									Animation(filename, sprite_file, &data, &sprite);
+							}
+						});
+						std::remove(filename.c_str());
+					});
+				}
+			}
+
+			for (double animation_count : { 8.0, 32.0 }) {
+				// Comparable to animation_load_sheet's atlas variant, the JSON atlas being compiled beforehand
+				suite.add("animation_load_archive", { { "animations", animation_count } }, [=](Benchmark& benchmark) {
+					const std::string json_filename("Aurora_benchmarks_animation.json");
+					const std::string filename("Aurora_benchmarks_animation.auanim");
+					std::vector<std::string> sprite_files;
+					for (size_t i = 0; i < static_cast<size_t>(animation_count); ++i)
+						sprite_files.push_back("Knight_Action" + std::to_string(i) + "_");
+					writeAnimationFile(json_filename, sprite_files, 32);
+					AnimationAtlas atlas;
+					atlas.loadFromFile(json_filename);
+					AnimationArchive::compile(atlas, filename);
+
+					sf::Texture texture;
+					SpriteNode sprite(texture);
+					benchmark.measure([&]() {
+						AnimationArchive archive;
+						archive.openFromFile(filename);
+						for (const std::string& sprite_file : sprite_files) {
+							Animation::Data data;
+							data.total_duration = sf::seconds(1.f);
+							Animation animation(&data, &sprite);
+							animation.loadFrames(archive, sprite_file);
+						}
+					});
+					std::remove(json_filename.c_str());
+					std::remove(filename.c_str());
+				});
+			}
+
+			for (bool shared : { false, true }) {
+				// 0: every unit parses the file into its own data, 1: the units share the data of an animation library
+				suite.add("animation_load_units", { { "units", 1000.0 }, { "shared", shared } }, [=](Benchmark& benchmark) {
+					const std::string filename("Aurora_benchmarks_animation.json");
+					writeAnimationFile(filename, { "Knight_Walk" }, 32);
+
+					sf::Texture texture;
+					SpriteNode sprite(texture);
+					size_t stored_frames = 0;
+					benchmark.measure([&]() {
+						AnimationLibrary library;
+						std::vector<std::unique_ptr<Animation::Data>> unit_data;
+						std::vector<std::unique_ptr<Animation>> units;
+						for (size_t i = 0; i < 1000; ++i) {
+							if (shared)
+								units.push_back(std::make_unique<Animation>(library.load(filename, "Knight_Walk", sf::seconds(1.f)), &sprite));
+							else {
+								unit_data.push_back(std::make_unique<Animation::Data>());
+								unit_data.back()->total_duration = sf::seconds(1.f);
+								unit_data.back()->repeat = true;
+								unit_data.back()->loopback = false;
+								units.push_back(std::make_unique<Animation>(filename, "Knight_Walk", unit_data.back().get(), &sprite));
+							}
+						}
+
+						stored_frames = shared ? library.find(filename, "Knight_Walk")->frames.size() : 0;
+						for (const auto& data : unit_data)
+							stored_frames += data->frames.size();
+					});
+					benchmark.setCounter("stored_frames", static_cast<double>(stored_frames));
+					std::remove(filename.c_str());
+				});
+			}
+
+			for (double animation_count : { 1000.0, 10000.0 }) {
+				for (bool system : { false, true }) {
+					// 0: every animation is a scene node, 1: the animations are stepped by an animation system
+					const BenchmarkSuite::Parameters parameters = { { "animations", animation_count }, { "system", system } };
+
+					suite.add("animation_step", parameters, [=](Benchmark& benchmark) {
+						auto data(std::make_shared<Animation::Data>());
+						data->total_duration = sf::seconds(0.5f);
+						data->repeat = true;
+						data->loopback = false;
+						for (unsigned i = 0; i < 16; ++i) {
+							data->frames.emplace_back();
+							data->frames.back().texture_rect = sf::FloatRect(i * 64.f, 0.f, 64.f, 64.f);
+							data->frames.back().origin = sf::Vector2f(0.5f, 0.5f);
+							data->frames.back().duration = data->total_duration / 16.f;
+						}
+						data->finalize();
+
+						sf::Texture texture;
+						SceneNode root;
+						auto animation_system(std::make_unique<AnimationSystem>());
+						AnimationSystem& animations = *animation_system;
+						root.attachChild(std::move(animation_system));
+						for (size_t i = 0; i < static_cast<size_t>(animation_count); ++i) {
+							auto sprite(std::make_unique<SpriteNode>(texture));
+							if (system)
+								animations.add(data, *sprite);
+							else {
+								auto animation(std::make_unique<Animation>(data, sprite.get()));
+								animation->restart();
+								root.attachChild(std::move(animation));
+							}
+							root.attachChild(std::move(sprite));
+						}
+						benchmark.measure([&]() { root.update(FrameTime); });
+						if (system)
+							benchmark.setCounter("frame_changes", static_cast<double>(animations.getFrameChangeCount()));
+					});
+				}
+			}
+
+			for (double frame_count : { 16.0, 1024.0 }) {
+				suite.add("animation_seek", { { "frames", frame_count }, { "seeks", 1000.0 } }, [=](Benchmark& benchmark) {
+					// Ping-pong animation of frames of varying durations
+					auto data(std::make_shared<Animation::Data>());
+					data->repeat = true;
+					data->loopback = true;
+					for (unsigned i = 0; i < static_cast<unsigned>(frame_count); ++i) {
+						data->frames.emplace_back();
+						data->frames.back().texture_rect = sf::FloatRect(i % 16 * 64.f, i / 16 * 64.f, 64.f, 64.f);
+						data->frames.back().origin = sf::Vector2f(0.5f, 0.5f);
+						data->frames.back().duration = sf::milliseconds(20 + i % 7 * 10);
+					}
+					data->finalize();
+
+					sf::Texture texture;
+					SpriteNode sprite(texture);
+					Animation animation(data, &sprite);
+					animation.restart();
+					benchmark.measure([&]() {
+						for (int i = 0; i < 1000; ++i)
+							animation.seek(sf::milliseconds(i * 7919));
+					});
+					benchmark.setCounter("stored_frames", static_cast<double>(data->frames.size()));
+				});
+			}
+		}
+	}
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+
+#include "Benchmark.h"
+
+namespace au
+{
+	namespace bench
+	{
+		namespace
+		{
+			void writeJsonObject(std::ostream& stream, const std::map<std::string, double>& values)
+			{
+				stream << '{' << std::defaultfloat << std::setprecision(15);
+				for (auto itr = values.begin(); itr != values.end(); ++itr)
+					stream << (itr == values.begin() ? "" : ", ") << '"' << itr->first << "\": " << itr->second;
+				stream << '}';
+			}
+		}
+
+		Benchmark::Benchmark(double min_time, unsigned min_iterations)
+			: min_time_(min_time)
+			, min_iterations_(min_iterations)
+		{
+		}
+
+		BenchmarkSuite::BenchmarkSuite(double min_time, unsigned min_iterations)
+			: min_time_(min_time)
+			, min_iterations_(min_iterations)
+		{
+		}
+
+		void BenchmarkSuite::add(const std::string& name, const Parameters& parameters, Function function)
+		{
+			entries_.push_back({ name, parameters, std::move(function) });
+		}
+
+		void BenchmarkSuite::run(const std::string& filter, std::ostream& log)
+		{
+			results_.clear();
+			for (const Entry& entry : entries_) {
+				if (entry.name.find(filter) == std::string::npos)
+					continue;
+
+				log << std::left << std::setw(32) << entry.name << std::defaultfloat << std::setprecision(10);
+				for (const auto& parameter : entry.parameters)
+					log << ' ' << parameter.first << '=' << parameter.second;
+				log << std::flush;
+
+				Benchmark benchmark(min_time_, min_iterations_);
+				entry.function(benchmark);
+
+				std::vector<double> samples(benchmark.getSamples());
+				if (samples.empty()) {
+					log << "  (no samples)\n";
+					continue;
+				}
+				std::sort(samples.begin(), samples.end());
+
+				Result result;
+				result.name = entry.name;
+				result.parameters = entry.parameters;
+				result.iterations = static_cast<unsigned>(samples.size());
+				result.mean_ns = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+				result.median_ns = samples[samples.size() / 2];
+				result.min_ns = samples.front();
+				result.max_ns = samples.back();
+				result.counters = benchmark.getCounters();
+				results_.push_back(result);
+
+				log << "  median " << std::fixed << std::setprecision(3) << result.median_ns / 1e6 << " ms ("
+				    << result.iterations << " iterations)\n";
+			}
+		}
+
+		void BenchmarkSuite::writeJson(std::ostream& stream) const
+		{
+			stream << "{\n  \"suite\": \"Aurora_benchmarks\",\n  \"results\": [";
+			for (size_t i = 0; i < results_.size(); ++i) {
+				const Result& result = results_[i];
+				stream << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name << "\", \"parameters\": ";
+				writeJsonObject(stream, result.parameters);
+				stream << std::fixed << std::setprecision(1)
+				       << ", \"iterations\": " << result.iterations
+				       << ", \"mean_ns\": " << result.mean_ns
+				       << ", \"median_ns\": " << result.median_ns
+				       << ", \"min_ns\": " << result.min_ns
+				       << ", \"max_ns\": " << result.max_ns
+				       << ", \"counters\": ";
+				writeJsonObject(stream, result.counters);
+				stream << '}';
+			}
+			stream << "\n  ]\n}\n";
+		}
+	}
+}
@@ -0,0 +1,128 @@
+#ifndef Aurora_Benchmarks_Benchmark_H_
+#define Aurora_Benchmarks_Benchmark_H_
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace au
+{
+	namespace bench
+	{
+		/// <summary>
+		/// Context handed to a benchmark function<para/>
+		/// The function prepares its data, then passes the measured work to the measure method
+		/// </summary>
+		class Benchmark
+		{
+		public:
+			/// <summary>Constructs the context</summary>
+			/// <param name="min_time">The minimum total time spent in the measured iterations (in seconds)</param>
+			/// <param name="min_iterations">The minimum amount of measured iterations</param>
+			Benchmark(double min_time, unsigned min_iterations);
+		public:
+			/// <summary>
+			/// Runs one warm-up iteration, then times iterations until both the minimum time<para/>
+			/// and the minimum amount of iterations are reached
+			/// </summary>
+			/// <param name="iteration">Callable performing one iteration of the measured work</param>
+			template <typename Iteration>
+			void measure(Iteration iteration);
+			/// <summary>Sets a value reported alongside the timings (draw calls, items, etc.)</summary>
+			/// <param name="name">The counter's name</param>
+			/// <param name="value">The counter's value</param>
+			inline void setCounter(const std::string& name, double value) { counters_[name] = value; }
+			/// <summary>Returns the duration of every measured iteration</summary>
+			/// <returns>The durations in nanoseconds</returns>
+			inline const std::vector<double>& getSamples() const { return samples_; }
+			/// <summary>Returns the counters set by the benchmark</summary>
+			/// <returns>The counters</returns>
+			inline const std::map<std::string, double>& getCounters() const { return counters_; }
+
+		private:
+			double                        min_time_;
+			unsigned                      min_iterations_;
+			std::vector<double>           samples_;
+			std::map<std::string, double> counters_;
+		};
+
+		/// <summary>Set of named benchmarks whose results are written as JSON</summary>
+		class BenchmarkSuite
+		{
+		public:
+			using Function = std::function<void(Benchmark&)>;
+			using Parameters = std::map<std::string, double>;
+
+			/// <summary>Timings and counters of a benchmark</summary>
+			struct Result
+			{
+				std::string                   name;
+				Parameters                    parameters;
+				unsigned                      iterations;
+				double                        mean_ns;
+				double                        median_ns;
+				double                        min_ns;
+				double                        max_ns;
+				std::map<std::string, double> counters;
+			};
+
+		public:
+			/// <summary>Constructs the suite</summary>
+			/// <param name="min_time">The minimum time spent measuring each benchmark (in seconds)</param>
+			/// <param name="min_iterations">The minimum amount of measured iterations of each benchmark</param>
+			BenchmarkSuite(double min_time, unsigned min_iterations);
+		public:
+			/// <summary>Registers a benchmark</summary>
+			/// <param name="name">The benchmark's name</param>
+			/// <param name="parameters">The benchmark's parameters (node count, particle count, etc.)</param>
+			/// <param name="function">The benchmark's function</param>
+			void add(const std::string& name, const Parameters& parameters, Function function);
+			/// <summary>Runs the benchmarks whose name contains the filter</summary>
+			/// <param name="filter">The filter, an empty filter runs every benchmark</param>
+			/// <param name="log">Stream on which the progress is written</param>
+			void run(const std::string& filter, std::ostream& log);
+			/// <summary>Writes the results of the last run as JSON</summary>
+			/// <param name="stream">The output stream</param>
+			void writeJson(std::ostream& stream) const;
+			/// <summary>Returns the results of the last run</summary>
+			/// <returns>The results</returns>
+			inline const std::vector<Result>& getResults() const { return results_; }
+
+		private:
+			struct Entry
+			{
+				std::string name;
+				Parameters  parameters;
+				Function    function;
+			};
+
+			double              min_time_;
+			unsigned            min_iterations_;
+			std::vector<Entry>  entries_;
+			std::vector<Result> results_;
+		};
+
+		template <typename Iteration>
+		void Benchmark::measure(Iteration iteration)
+		{
+			using Clock = std::chrono::steady_clock;
+
+			iteration();
+
+			samples_.clear();
+			double total_time = 0.0;
+			while (samples_.size() < min_iterations_ || total_time < min_time_ * 1e9) {
+				const Clock::time_point start(Clock::now());
+				iteration();
+				const double duration = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+				samples_.push_back(duration);
+				total_time += duration;
+			}
+		}
+	}
+}
+#endif
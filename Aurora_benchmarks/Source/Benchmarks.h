@@ -0,0 +1,24 @@
+#ifndef Aurora_Benchmarks_Benchmarks_H_
+#define Aurora_Benchmarks_Benchmarks_H_
+
+#include "Benchmark.h"
+
+namespace au
+{
+	namespace bench
+	{
+		/// <summary>Registers the scene graph update and draw benchmarks</summary>
+		/// <param name="suite">The benchmark suite</param>
+		void registerSceneBenchmarks(BenchmarkSuite& suite);
+		/// <summary>Registers the particle system benchmarks</summary>
+		/// <param name="suite">The benchmark suite</param>
+		void registerParticleBenchmarks(BenchmarkSuite& suite);
+		/// <summary>Registers the animation parsing and stepping benchmarks</summary>
+		/// <param name="suite">The benchmark suite</param>
+		void registerAnimationBenchmarks(BenchmarkSuite& suite);
+		/// <summary>Registers the resource holder and sound player benchmarks</summary>
+		/// <param name="suite">The benchmark suite</param>
+		void registerResourceBenchmarks(BenchmarkSuite& suite);
+	}
+}
+#endif
@@ -0,0 +1,30 @@
+#include "CountingRenderTarget.h"
+
+namespace au
+{
+	namespace bench
+	{
+		CountingRenderTarget::CountingRenderTarget(const sf::Vector2u& size)
+			: size_(size)
+			, draw_call_count_(0)
+		{
+			initialize();
+		}
+
+		sf::Vector2u CountingRenderTarget::getSize() const
+		{
+			return size_;
+		}
+
+#if SFML_VERSION_MAJOR == 2 && SFML_VERSION_MINOR < 5
+		bool CountingRenderTarget::activate(bool active)
+#else
+		bool CountingRenderTarget::setActive(bool active)
+#endif
+		{
+			if (active)
+				draw_call_count_++;
+			return false;
+		}
+	}
+}
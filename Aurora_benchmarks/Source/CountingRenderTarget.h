@@ -0,0 +1,51 @@
+#ifndef Aurora_Benchmarks_CountingRenderTarget_H_
+#define Aurora_Benchmarks_CountingRenderTarget_H_
+
+#include <SFML/Config.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+
+namespace au
+{
+	namespace bench
+	{
+		/// <summary>
+		/// Render target without an OpenGL context that counts the draw calls it receives<para/>
+		/// SFML activates a render target before every draw call and skips the call if the activation<para/>
+		/// fails, refusing every activation turns every draw into a counted no-op so that the suite runs<para/>
+		/// on machines without a GPU
+		/// </summary>
+		class CountingRenderTarget : public sf::RenderTarget
+		{
+		public:
+			/// <summary>Constructs the render target</summary>
+			/// <param name="size">The target's size, used by its default view</param>
+			explicit CountingRenderTarget(const sf::Vector2u& size);
+		public:
+			/// <summary>Returns the target's size</summary>
+			/// <returns>The target's size</returns>
+			virtual sf::Vector2u getSize() const override;
+			/// <summary>Returns the amount of draw calls received since the last reset</summary>
+			/// <returns>The amount of draw calls</returns>
+			inline unsigned getDrawCallCount() const { return draw_call_count_; }
+			/// <summary>Resets the amount of draw calls</summary>
+			inline void resetDrawCallCount() { draw_call_count_ = 0; }
+#if SFML_VERSION_MAJOR == 2 && SFML_VERSION_MINOR < 5
+		private:
+			/// <summary>Counts the draw call and refuses the activation</summary>
+			/// <param name="active">True to activate, false to deactivate</param>
+			/// <returns>Always false</returns>
+			virtual bool activate(bool active) override;
+#else
+			/// <summary>Counts the draw call and refuses the activation</summary>
+			/// <param name="active">True to activate, false to deactivate</param>
+			/// <returns>Always false</returns>
+			virtual bool setActive(bool active = true) override;
+#endif
+
+		private:
+			sf::Vector2u size_;
+			unsigned     draw_call_count_;
+		};
+	}
+}
+#endif
@@ -0,0 +1,296 @@
+#include <ParticleBudget.h>
+#include <ParticleCollisionGrid.h>
+#include <ParticleManager.h>
+#include <ParticleSystemT.h>
+
+#include "Benchmarks.h"
+#include "CountingRenderTarget.h"
+
+namespace au
+{
+	namespace bench
+	{
+		namespace
+		{
+			const sf::Time FrameTime(sf::seconds(1.f / 60.f));
+
+			/// <summary>How the particles of a benchmarked system are moved</summary>
+			enum class Pipeline { Affector, Integration, Static };
+
+			/// <summary>Initializer of the benchmarked long-lived particles</summary>
+			struct LongLivedParticle
+			{
+				Particle operator()() const
+				{
+					Particle particle;
+					particle.size = sf::Vector2f(4.f, 4.f);
+					particle.velocity = sf::Vector2f(20.f, -40.f);
+					particle.acceleration = sf::Vector2f(0.f, 98.f);
+					particle.color = sf::Color::White;
+					particle.lifetime = sf::seconds(3600.f);
+					return particle;
+				}
+			};
+
+			/// <summary>Initializer of the benchmarked particles of continuously emitting systems</summary>
+			struct ShortLivedParticle
+			{
+				Particle operator()() const
+				{
+					Particle particle = LongLivedParticle()();
+					particle.lifetime = sf::seconds(1.f);
+					return particle;
+				}
+			};
+
+			/// <summary>
+			/// Particle system filled up to its maximum amount of long-lived particles<para/>
+			/// The particles are moved by a per-particle std::function affector, by the built-in integration<para/>
+			/// or by the fused affectors of a ParticleSystemT, sequentially or on the default task pool
+			/// </summary>
+			struct ParticleScene
+			{
+				ParticleScene(size_t particle_count, Pipeline pipeline, bool parallel = false)
+				{
+					std::unique_ptr<ParticleSystem> particle_system;
+					if (pipeline == Pipeline::Static)
+						particle_system = makeParticleSystem(LongLivedParticle(), affectors::Drag(0.1f), affectors::Integration());
+					else {
+						particle_system = std::make_unique<ParticleSystem>();
+						particle_system->setInitializer(LongLivedParticle());
+						if (pipeline == Pipeline::Integration)
+							particle_system->activateIntegration(true);
+						else
+							particle_system->setAffector([](Particle& particle, sf::Time dt) {
+								particle.velocity += particle.acceleration * dt.asSeconds();
+								particle.position += particle.velocity * dt.asSeconds();
+							});
+					}
+
+					system = particle_system.get();
+					system->setMaxParticles(particle_count);
+					system->activateEmitter(true);
+					system->emitBurst(particle_count);
+					system->activateParallelSimulation(parallel);
+					root.attachChild(std::move(particle_system));
+				}
+
+				SceneNode       root;
+				ParticleSystem* system;
+			};
+
+			/// <summary>Initializer of the benchmarked particles spreading out in every direction</summary>
+			struct SpreadingParticle
+			{
+				Particle operator()()
+				{
+					Particle particle = LongLivedParticle()();
+					particle.velocity = sf::Vector2f(static_cast<float>(index % 100) * 8.f - 400.f,
+					                                 static_cast<float>(index / 100 % 100) * 8.f - 400.f);
+					particle.acceleration = sf::Vector2f(0.f, 0.f);
+					index++;
+					return particle;
+				}
+
+				unsigned index = 0;
+			};
+
+			/// <summary>
+			/// Particle system sticking to a lattice of square colliders, tested through a collision grid<para/>
+			/// or against every collider by a span affector
+			/// </summary>
+			struct CollisionScene
+			{
+				CollisionScene(size_t particle_count, size_t collider_count, bool grid)
+				{
+					auto collision_grid(std::make_unique<ParticleCollisionGrid>(64.f));
+					const size_t columns = static_cast<size_t>(std::sqrt(static_cast<double>(collider_count)));
+					for (size_t i = 0; i < collider_count; ++i) {
+						const sf::FloatRect bounds(static_cast<float>(i % columns) * 64.f - 1024.f,
+						                           static_cast<float>(i / columns) * 64.f - 1024.f, 32.f, 32.f);
+						colliders.push_back(bounds);
+						collision_grid->addCollider(bounds);
+					}
+
+					auto particle_system(std::make_unique<ParticleSystem>());
+					particle_system->setInitializer(SpreadingParticle());
+					particle_system->activateIntegration(true);
+					if (grid)
+						particle_system->setCollisionGrid(collision_grid.get(), CollisionResponse::Stick);
+					else
+						particle_system->setSpanAffector([this](const ParticleSpan& span, sf::Time) {
+							for (size_t i = 0; i < span.count; ++i)
+								for (const sf::FloatRect& bounds : colliders)
+									if (bounds.contains(span.position_x[i], span.position_y[i])) {
+										span.velocity_x[i] = span.velocity_y[i] = 0.f;
+										break;
+									}
+						});
+					particle_system->setMaxParticles(particle_count);
+					particle_system->emitBurst(particle_count);
+
+					root.attachChild(std::move(collision_grid));
+					root.attachChild(std::move(particle_system));
+				}
+
+				std::vector<sf::FloatRect> colliders;
+				SceneNode                  root;
+			};
+
+			/// <summary>
+			/// Continuously emitting particle systems of alternating priorities, half of them situated outside of the view
+			/// </summary>
+			struct BudgetScene
+			{
+				explicit BudgetScene(size_t system_count)
+				{
+					for (size_t i = 0; i < system_count; ++i) {
+						auto particle_system(makeParticleSystem(ShortLivedParticle(), affectors::Drag(0.1f), affectors::Integration()));
+						particle_system->setEmitterPosition(sf::Vector2f(i % 2 == 0 ? 512.f : -4096.f, static_cast<float>(i)));
+						particle_system->setEmissionRate(6000.f);
+						particle_system->activateEmitter(true);
+						particle_system->setPriority(i % 4 < 2 ? ParticleBudget::Priority::Normal : ParticleBudget::Priority::Low);
+						root.attachChild(std::move(particle_system));
+					}
+				}
+
+				SceneNode root;
+			};
+
+			/// <summary>
+			/// Many small emitters sharing a texture, either as one particle system node per emitter<para/>
+			/// or as the emitters of a single particle manager, simulated sequentially or on the default task pool
+			/// </summary>
+			struct EmitterScene
+			{
+				EmitterScene(size_t emitter_count, size_t particles_per_emitter, bool manager, bool parallel)
+				{
+					if (manager) {
+						auto particle_manager(std::make_unique<ParticleManager>());
+						particle_manager->activateIntegration(true);
+						particle_manager->activateParallelSimulation(parallel);
+						ParticleManager::EmitterSettings settings;
+						settings.initializer = LongLivedParticle();
+						settings.texture = &texture;
+						settings.burst = particles_per_emitter;
+						for (size_t i = 0; i < emitter_count; ++i) {
+							settings.texture_rect = sf::IntRect(static_cast<int>(i % 4) * 16, 0, 16, 16);
+							settings.position = sf::Vector2f(static_cast<float>(i), 0.f);
+							particle_manager->createEmitter(settings);
+						}
+						root.attachChild(std::move(particle_manager));
+					}
+					else
+						for (size_t i = 0; i < emitter_count; ++i) {
+							auto particle_system(std::make_unique<ParticleSystem>(sf::Quads, particles_per_emitter, &texture));
+							particle_system->setInitializer(LongLivedParticle());
+							particle_system->activateIntegration(true);
+							particle_system->setEmitterPosition(sf::Vector2f(static_cast<float>(i), 0.f));
+							particle_system->emitBurst(particles_per_emitter);
+							particle_system->activateParallelSimulation(parallel);
+							root.attachChild(std::move(particle_system));
+						}
+				}
+
+				sf::Texture texture;
+				SceneNode   root;
+			};
+		}
+
+		void registerParticleBenchmarks(BenchmarkSuite& suite)
+		{
+			for (double particle_count : { 1000.0, 10000.0, 100000.0 }) {
+				for (Pipeline pipeline : { Pipeline::Affector, Pipeline::Integration, Pipeline::Static }) {
+					// 0: per-particle affector, 1: built-in integration, 2: fused compile-time affectors
+					const BenchmarkSuite::Parameters parameters = { { "particles", particle_count },
+					                                                { "pipeline", static_cast<double>(pipeline) } };
+
+					suite.add("particle_update", parameters, [=](Benchmark& benchmark) {
+						ParticleScene scene(static_cast<size_t>(particle_count), pipeline);
+						benchmark.measure([&]() { scene.root.update(FrameTime); });
+					});
+				}
+
+				for (bool parallel : { false, true }) {
+					// The parallel simulation only completes once the particles are drawn
+					const BenchmarkSuite::Parameters parameters = { { "particles", particle_count }, { "parallel", parallel } };
+
+					suite.add("particle_frame", parameters, [=](Benchmark& benchmark) {
+						ParticleScene scene(static_cast<size_t>(particle_count), Pipeline::Static, parallel);
+						CountingRenderTarget target(sf::Vector2u(1024, 768));
+						benchmark.measure([&]() {
+							scene.root.update(FrameTime);
+							target.draw(scene.root);
+						});
+					});
+				}
+
+				suite.add("particle_draw", { { "particles", particle_count } }, [=](Benchmark& benchmark) {
+					ParticleScene scene(static_cast<size_t>(particle_count), Pipeline::Integration);
+					CountingRenderTarget target(sf::Vector2u(1024, 768));
+					benchmark.measure([&]() {
+						target.resetDrawCallCount();
+						target.draw(scene.root);
+					});
+					benchmark.setCounter("draw_calls", target.getDrawCallCount());
+				});
+			}
+
+			for (double collider_count : { 100.0, 1000.0 }) {
+				for (bool grid : { false, true }) {
+					// 0: every particle tested against every collider, 1: collision grid
+					const BenchmarkSuite::Parameters parameters = { { "particles", 10000.0 }, { "colliders", collider_count },
+					                                                { "grid", grid } };
+
+					suite.add("particle_collision", parameters, [=](Benchmark& benchmark) {
+						CollisionScene scene(10000, static_cast<size_t>(collider_count), grid);
+						benchmark.measure([&]() { scene.root.update(FrameTime); });
+					});
+				}
+			}
+
+			for (double budget : { 0.0, 1.0 }) {
+				// The budget is in milliseconds per frame, 0 for an inactive budget
+				suite.add("particle_budget_frame", { { "budget_ms", budget } }, [=](Benchmark& benchmark) {
+					ParticleBudget& particle_budget = ParticleBudget::getDefault();
+					particle_budget.setFrameBudget(sf::microseconds(static_cast<sf::Int64>(budget * 1000.0)));
+
+					BudgetScene scene(32);
+					CountingRenderTarget target(sf::Vector2u(1024, 768));
+					benchmark.measure([&]() {
+						scene.root.update(FrameTime);
+						target.draw(scene.root);
+						particle_budget.endFrame();
+					});
+
+					const ParticleBudget::Stats& stats = particle_budget.getLastFrameStats();
+					benchmark.setCounter("level", stats.level);
+					benchmark.setCounter("shed_particles", static_cast<double>(stats.shed_particles));
+					benchmark.setCounter("capped_particles", static_cast<double>(stats.capped_particles));
+					benchmark.setCounter("culled_systems", static_cast<double>(stats.culled_systems));
+					particle_budget.setFrameBudget(sf::Time::Zero);
+				});
+			}
+
+			for (double emitter_count : { 100.0, 500.0 }) {
+				for (bool manager : { false, true }) {
+					for (bool parallel : { false, true }) {
+						const BenchmarkSuite::Parameters parameters = { { "emitters", emitter_count }, { "manager", manager },
+						                                                { "parallel", parallel } };
+
+						suite.add("particle_emitters_frame", parameters, [=](Benchmark& benchmark) {
+							EmitterScene scene(static_cast<size_t>(emitter_count), 64, manager, parallel);
+							CountingRenderTarget target(sf::Vector2u(1024, 768));
+							benchmark.measure([&]() {
+								target.resetDrawCallCount();
+								scene.root.update(FrameTime);
+								target.draw(scene.root);
+							});
+							benchmark.setCounter("draw_calls", target.getDrawCallCount());
+						});
+					}
+				}
+			}
+		}
+	}
+}
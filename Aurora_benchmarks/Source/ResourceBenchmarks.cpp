@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Clock.hpp>
+#include <SFML/Audio/SoundBuffer.hpp>
+
+#include <ResourceHolder.h>
+#include <Audio/SoundPlayer.h>
+
+#include "Benchmarks.h"
+
+namespace au
+{
+	namespace bench
+	{
+		void registerResourceBenchmarks(BenchmarkSuite& suite)
+		{
+			for (double resource_count : { 16.0, 256.0 }) {
+				suite.add("resource_lookup", { { "resources", resource_count } }, [=](Benchmark& benchmark) {
+					const std::string filename("Aurora_benchmarks_image.png");
+					sf::Image image;
+					image.create(4, 4, sf::Color::White);
+					image.saveToFile(filename);
+
+					const int count = static_cast<int>(resource_count);
+					ImageHolder<int> images;
+					for (int id = 0; id < count; ++id)
+						images.load(filename, id);
+					std::remove(filename.c_str());
+
+					const unsigned lookup_count = 100000;
+					unsigned width_sum = 0;
+					benchmark.measure([&]() {
+						for (unsigned i = 0; i < lookup_count; ++i)
+							width_sum += images.get(static_cast<int>(i * 7919u % count)).getSize().x;
+					});
+					benchmark.setCounter("lookups", lookup_count);
+					benchmark.setCounter("checksum", width_sum != 0);
+				});
+			}
+
+			for (double async : { 0.0, 1.0 }) {
+				suite.add("resource_load_async", { { "images", 32.0 }, { "async", async } }, [=](Benchmark& benchmark) {
+					const int count = 32;
+					std::vector<std::string> filenames;
+					for (int id = 0; id < count; ++id) {
+						sf::Image image;
+						image.create(512, 512, sf::Color(static_cast<sf::Uint8>(id * 8), 128, 255));
+						filenames.push_back("Aurora_benchmarks_image" + std::to_string(id) + ".png");
+						image.saveToFile(filenames.back());
+					}
+
+					// Longest time the main thread was kept busy by a single call, the whole load when synchronous
+					TaskPool pool(3);
+					double max_step = 0.0;
+					benchmark.measure([&]() {
+						ImageHolder<int> images;
+						sf::Clock clock;
+						if (async != 0.0) {
+							for (int id = 0; id < count; ++id)
+								images.loadAsync(filenames[id], id, pool);
+							while (images.getPendingAsyncLoadCount() > 0) {
+								clock.restart();
+								images.finalizeAsyncLoads(sf::milliseconds(1));
+								max_step = std::max(max_step, clock.getElapsedTime().asSeconds() * 1000.0);
+							}
+						}
+						else {
+							for (int id = 0; id < count; ++id)
+								images.load(filenames[id], id);
+							max_step = std::max(max_step, clock.getElapsedTime().asSeconds() * 1000.0);
+						}
+					});
+					benchmark.setCounter("max_step_ms", max_step);
+
+					for (const auto& filename : filenames)
+						std::remove(filename.c_str());
+				});
+			}
+
+			for (double play_count : { 64.0, 256.0 }) {
+				suite.add("sound_play_churn", { { "plays", play_count } }, [=](Benchmark& benchmark) {
+					const std::string filename("Aurora_benchmarks_sound.wav");
+					std::vector<sf::Int16> samples(2205, 0);
+					sf::SoundBuffer buffer;
+					buffer.loadFromSamples(samples.data(), samples.size(), 1, 44100);
+					buffer.saveToFile(filename);
+
+					SoundPlayer<int> player;
+					player.loadEffect(filename, SoundProperties(), 0);
+					std::remove(filename.c_str());
+
+					benchmark.measure([&]() {
+						for (unsigned i = 0; i < static_cast<unsigned>(play_count); ++i)
+							player.play(sf::Vector2f(static_cast<float>(i), 0.f), 0);
+						player.stopSounds();
+					});
+				});
+			}
+		}
+	}
+}
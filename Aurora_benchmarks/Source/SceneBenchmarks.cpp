@@ -0,0 +1,98 @@
+#include <array>
+
+#include <SFML/Graphics/Texture.hpp>
+
+#include <SpriteNode.h>
+#include <RenderQueue.h>
+
+#include "Benchmarks.h"
+#include "CountingRenderTarget.h"
+
+namespace au
+{
+	namespace bench
+	{
+		namespace
+		{
+			const sf::Time FrameTime(sf::seconds(1.f / 60.f));
+
+			/// <summary>Sprite moving and rotating every update, invalidating its world transform</summary>
+			class MovingSprite : public SpriteNode
+			{
+			public:
+				explicit MovingSprite(const sf::Texture& texture)
+					: SpriteNode(texture, sf::FloatRect(0.f, 0.f, 16.f, 16.f))
+				{
+				}
+			private:
+				virtual void updateCurrent(sf::Time dt) override
+				{
+					move(10.f * dt.asSeconds(), 0.f);
+					rotate(45.f * dt.asSeconds());
+				}
+			};
+
+			/// <summary>Scene of layers holding sprites that alternate between a few textures</summary>
+			struct Scene
+			{
+				static const size_t LayerCount = 16;
+
+				explicit Scene(size_t node_count, bool linear_storage)
+				{
+					for (size_t i = 0; i < LayerCount; ++i) {
+						auto layer(std::make_unique<SceneNode>());
+						layers[i] = layer.get();
+						root.attachChild(std::move(layer));
+					}
+					for (size_t i = 0; i < node_count; ++i) {
+						auto sprite(std::make_unique<MovingSprite>(textures[i % textures.size()]));
+						sprite->setPosition(static_cast<float>(i % 1024), static_cast<float>(i / 1024));
+						layers[i % LayerCount]->attachChild(std::move(sprite));
+					}
+					root.activateLinearStorage(linear_storage);
+				}
+
+				std::array<sf::Texture, 4>            textures;
+				SceneNode                             root;
+				std::array<SceneNode*, LayerCount>    layers;
+			};
+		}
+
+		void registerSceneBenchmarks(BenchmarkSuite& suite)
+		{
+			for (double node_count : { 1000.0, 10000.0, 100000.0 }) {
+				for (bool linear_storage : { false, true }) {
+					const BenchmarkSuite::Parameters parameters = { { "nodes", node_count }, { "linear_storage", linear_storage } };
+
+					suite.add("scene_update", parameters, [=](Benchmark& benchmark) {
+						Scene scene(static_cast<size_t>(node_count), linear_storage);
+						benchmark.measure([&]() { scene.root.update(FrameTime); });
+					});
+
+					suite.add("scene_draw", parameters, [=](Benchmark& benchmark) {
+						Scene scene(static_cast<size_t>(node_count), linear_storage);
+						CountingRenderTarget target(sf::Vector2u(1024, 768));
+						benchmark.measure([&]() {
+							target.resetDrawCallCount();
+							target.draw(scene.root);
+						});
+						benchmark.setCounter("draw_calls", target.getDrawCallCount());
+					});
+
+					suite.add("scene_draw_queued", parameters, [=](Benchmark& benchmark) {
+						Scene scene(static_cast<size_t>(node_count), linear_storage);
+						CountingRenderTarget target(sf::Vector2u(1024, 768));
+						RenderQueue queue;
+						benchmark.measure([&]() {
+							target.resetDrawCallCount();
+							scene.root.enqueue(queue);
+							queue.flush(target);
+						});
+						benchmark.setCounter("draw_calls", target.getDrawCallCount());
+						benchmark.setCounter("submitted_items", queue.getStats().submitted_items);
+					});
+				}
+			}
+		}
+	}
+}
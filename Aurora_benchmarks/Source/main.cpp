@@ -0,0 +1,63 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Benchmarks.h"
+
+namespace
+{
+	void printUsage(const char* program)
+	{
+		std::cerr << "Usage: " << program << " [--filter name] [--output file.json] [--min-time seconds] [--min-iterations count]\n"
+		          << "Results are written as JSON to the output file, or to the standard output if none is given\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string filter;
+	std::string output;
+	double min_time = 0.5;
+	unsigned min_iterations = 5;
+	for (int i = 1; i < argc; ++i) {
+		const std::string argument(argv[i]);
+		if (argument == "--help" || i + 1 >= argc) {
+			printUsage(argv[0]);
+			return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		const std::string value(argv[++i]);
+		if (argument == "--filter")
+			filter = value;
+		else if (argument == "--output")
+			output = value;
+		else if (argument == "--min-time")
+			min_time = std::atof(value.c_str());
+		else if (argument == "--min-iterations")
+			min_iterations = static_cast<unsigned>(std::atoi(value.c_str()));
+		else {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	au::bench::BenchmarkSuite suite(min_time, min_iterations);
+	au::bench::registerSceneBenchmarks(suite);
+	au::bench::registerParticleBenchmarks(suite);
+	au::bench::registerAnimationBenchmarks(suite);
+	au::bench::registerResourceBenchmarks(suite);
+	suite.run(filter, std::cerr);
+
+	if (output.empty())
+		suite.writeJson(std::cout);
+	else {
+		std::ofstream file(output);
+		if (!file) {
+			std::cerr << "Unable to open " << output << '\n';
+			return EXIT_FAILURE;
+		}
+		suite.writeJson(file);
+	}
+	return EXIT_SUCCESS;
+}
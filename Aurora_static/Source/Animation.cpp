@@ -1,33 +1,210 @@
-#include <fstream>
-#include <functional>
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
 #include <iostream>
 
 #include "Animation.h"
 
 namespace au
 {
+	namespace
+	{
+		/// <summary>Finds the frame played at a time of the cycle, in O(log n)</summary>
+		/// <param name="frame_ends">The end times of the frames played forward</param>
+		/// <param name="time">The time, less than the cycle's duration</param>
+		/// <returns>The frame's index</returns>
+		unsigned findFrame(const std::vector<sf::Time>& frame_ends, sf::Time time)
+		{
+			// Played forward, the frame is the first one ending after the time
+			const sf::Time forward_duration(frame_ends.back());
+			if (time < forward_duration)
+				return static_cast<unsigned>(std::upper_bound(frame_ends.begin(), frame_ends.end(), time) - frame_ends.begin());
+
+			// Played back, the time is mirrored onto the forward timeline from the end of the penultimate frame
+			const sf::Time mirrored_time(frame_ends[frame_ends.size() - 2] - (time - forward_duration));
+			return static_cast<unsigned>(std::lower_bound(frame_ends.begin(), frame_ends.end() - 1, mirrored_time) - frame_ends.begin());
+		}
+	}
+
+	bool Animation::Data::loadFrames(const AnimationAtlas& atlas, const std::string& sprite_file)
+	{
+		// Frames are replaced rather than appended so that loading the data again doesn't duplicate them
+		frames.clear();
+		std::string name(sprite_file);
+		for (unsigned sprite_index = 1; ; ++sprite_index) {
+			name.resize(sprite_file.size());
+			name += std::to_string(sprite_index);
+			name += ".png";
+
+			const AnimationAtlas::Region* region = atlas.findRegion(name);
+			if (!region)
+				break;
+			frames.emplace_back();
+			frames.back().texture_rect = region->texture_rect;
+			frames.back().origin = region->origin;
+			frames.back().duration = region->duration;
+		}
+
+		if (frames.empty()) {
+			std::cerr << "Unable to find the frames of sprite file " << sprite_file << "\n";
+			return false;
+		}
+		finalize();
+		return true;
+	}
+
+	bool Animation::Data::loadFrames(const AnimationArchive& archive, const std::string& sprite_file)
+	{
+		AnimationArchive::View view;
+		if (!archive.findAnimation(sprite_file, view) || view.frame_count == 0) {
+			std::cerr << "Unable to find the frames of sprite file " << sprite_file << "\n";
+			return false;
+		}
+
+		repeat = (view.flags & AnimationArchive::Repeat) != 0;
+		loopback = (view.flags & AnimationArchive::Loopback) != 0;
+
+		frames.clear();
+		frames.resize(view.frame_count);
+		for (size_t i = 0; i < view.frame_count; ++i) {
+			const AnimationArchive::FrameRecord& record = view.frames[i];
+			frames[i].texture_rect = sf::FloatRect(record.texture_rect[0], record.texture_rect[1],
+			                                       record.texture_rect[2], record.texture_rect[3]);
+			frames[i].origin = sf::Vector2f(record.origin[0], record.origin[1]);
+			frames[i].duration = sf::microseconds(record.duration);
+		}
+		finalize();
+		return true;
+	}
+
+	void Animation::Data::finalize()
+	{
+		// Frames without a duration share the time the other frames leave of the total duration evenly,
+		// frames played back in reverse count twice
+		sf::Time timed_duration(sf::Time::Zero);
+		sf::Int64 untimed_count = 0;
+		for (size_t i = 0; i < frames.size(); ++i) {
+			const bool played_back = loopback && frames.size() > 1 && i + 2 <= frames.size() && i >= (repeat ? 1u : 0u);
+			const sf::Int64 count = played_back ? 2 : 1;
+			if (frames[i].duration > sf::Time::Zero)
+				timed_duration += frames[i].duration * count;
+			else
+				untimed_count += count;
+		}
+		if (untimed_count > 0) {
+			const sf::Time frame_duration(std::max(total_duration - timed_duration, sf::Time::Zero) / untimed_count);
+			for (auto& frame : frames)
+				if (frame.duration <= sf::Time::Zero)
+					frame.duration = frame_duration;
+		}
+
+		frame_ends.resize(frames.size());
+		sf::Time frame_end(sf::Time::Zero);
+		for (size_t i = 0; i < frames.size(); ++i)
+			frame_ends[i] = frame_end += frames[i].duration;
+		total_duration = getCycleDuration();
+	}
+
+	sf::Time Animation::Data::getCycleDuration() const
+	{
+		if (frame_ends.empty())
+			return sf::Time::Zero;
+		if (!loopback || frame_ends.size() == 1)
+			return frame_ends.back();
+
+		// Played back from the penultimate frame to the second one, or to the first one if the animation doesn't repeat
+		return frame_ends.back() + frame_ends[frame_ends.size() - 2] - (repeat ? frame_ends.front() : sf::Time::Zero);
+	}
+
+	unsigned Animation::Data::getFrameAt(sf::Time time) const
+	{
+		const sf::Time cycle_duration(getCycleDuration());
+		if (time < sf::Time::Zero || cycle_duration == sf::Time::Zero)
+			return 0;
+		if (repeat)
+			return findFrame(frame_ends, time % cycle_duration);
+		if (time >= cycle_duration)
+			return loopback ? 0 : static_cast<unsigned>(frames.size() - 1);
+		return findFrame(frame_ends, time);
+	}
+
+	bool Animation::Data::step(unsigned& frame, sf::Time& time, sf::Time dt) const
+	{
+		const sf::Time cycle_duration(getCycleDuration());
+		time += dt;
+		if (cycle_duration == sf::Time::Zero) {
+			time = sf::Time::Zero;
+			return repeat;
+		}
+
+		// Whole cycles are skipped at once whatever the time passed
+		if (repeat)
+			time = time % cycle_duration;
+		else if (time >= cycle_duration) {
+			time = cycle_duration;
+			frame = loopback ? 0 : static_cast<unsigned>(frames.size() - 1);
+			return false;
+		}
+		frame = findFrame(frame_ends, time);
+		return true;
+	}
+
 	Animation::Animation(Animation::Data* data, SpriteNode* node)
-		: data_(data)
+		: shared_data_()
+		, data_(data)
+		, node_(node)
+		, current_frame_(0)
+		, playback_time_(sf::Time::Zero)
+		, animation_ongoing_(false)
+	{
+		setEventSubscriptions({});
+		activateUpdating(ActivationTarget::All, false);
+	}
+
+	Animation::Animation(std::shared_ptr<const Animation::Data> data, SpriteNode* node)
+		: shared_data_(data ? std::move(data) : std::make_shared<const Data>())
+		, data_(shared_data_.get())
 		, node_(node)
-		, current_rect_(0)
-		, elapsed_time_(sf::Time::Zero)
+		, current_frame_(0)
+		, playback_time_(sf::Time::Zero)
 		, animation_ongoing_(false)
 	{
+		setEventSubscriptions({});
+		// Missing data (an animation the library couldn't load) is played like data without frames
+		assert(data_->frame_ends.size() == data_->frames.size());
 		activateUpdating(ActivationTarget::All, false);
+		if (!data_->frames.empty())
+			updateNodeProperties();
 	}
 
 	Animation::Animation(const std::string& data_file, const std::string& sprite_file,
 		                 Animation::Data* data, SpriteNode* node)
-		: data_(data)
+		: shared_data_()
+		, data_(data)
 		, node_(node)
-		, current_rect_(0)
-		, elapsed_time_(sf::Time::Zero)
+		, current_frame_(0)
+		, playback_time_(sf::Time::Zero)
 		, animation_ongoing_(false)
 	{
+		setEventSubscriptions({});
 		activateUpdating(ActivationTarget::All, false);
 		parseJsonFile(data_file, sprite_file);
 	}
 
+	Animation::Animation(const AnimationAtlas& atlas, const std::string& sprite_file,
+		                 Animation::Data* data, SpriteNode* node)
+		: shared_data_()
+		, data_(data)
+		, node_(node)
+		, current_frame_(0)
+		, playback_time_(sf::Time::Zero)
+		, animation_ongoing_(false)
+	{
+		setEventSubscriptions({});
+		activateUpdating(ActivationTarget::All, false);
+		loadFrames(atlas, sprite_file);
+	}
+
 	void Animation::start()
 	{
 		activateUpdating(ActivationTarget::Current, true);
@@ -40,138 +217,94 @@ namespace au
 
 	void Animation::restart()
 	{
-		current_rect_ = 0;
-		elapsed_time_ = sf::Time::Zero;
+		// Frames filled in by hand haven't been finalized
+		if (!shared_data_ && data_->frame_ends.size() != data_->frames.size())
+			const_cast<Data*>(data_)->finalize();
+
+		current_frame_ = 0;
+		playback_time_ = sf::Time::Zero;
 		activateUpdating(ActivationTarget::Current, true);
 		animation_ongoing_ = true;
+		if (!data_->frames.empty())
+			updateNodeProperties();
+	}
+
+	void Animation::seek(sf::Time time)
+	{
+		if (data_->frames.empty())
+			return;
+
+		// Stepping from the start of the cycle wraps or clamps the time like playing would
+		const unsigned previous_frame = current_frame_;
+		playback_time_ = sf::Time::Zero;
+		animation_ongoing_ = data_->step(current_frame_, playback_time_, std::max(time, sf::Time::Zero));
+		if (current_frame_ != previous_frame)
+			updateNodeProperties();
 	}
 
 	void Animation::parseJsonFile(const std::string& data_file, const std::string& sprite_file)
 	{
-		std::ifstream fin(data_file, std::ios::in);
-		if (fin.is_open()) {
-			unsigned sprite_index = 1;
-			while (!fin.eof()) {
-				fin.seekg(0);
-				std::string str_needed(sprite_file + std::to_string(sprite_index++) + ".png");
-				std::string str_read;
-
-				// Find filename
-				do {
-					std::getline(fin, str_read);
-				} while (str_read.find(str_needed) == std::string::npos && !fin.eof());
-				if (fin.eof())
-					break;
-
-				// Find frame
-				std::getline(fin, str_read);
-				fin.seekg(static_cast<size_t>(fin.tellg()) - (str_read.length() + 1));
-
-				// Find rect start
-				sf::FloatRect rect;
-				char ch;
-				do {
-					fin.get(ch);
-				} while (ch != '{');
-
-				// Find values
-				std::function<std::string()> findNextValue([&fin]() -> std::string {
-					std::string value("");
-					char ch;
-					do {
-						fin.get(ch);
-					} while (ch != ':');
-
-					while (true) {
-						fin.get(ch);
-						if (ch != ',' && ch != '}')
-							value += ch;
-						else
-							break;
-					}
-
-					return value;
-				});
-
-				rect.left = std::stof(findNextValue());
-				rect.top = std::stof(findNextValue());
-				rect.width = std::stof(findNextValue());
-				rect.height = std::stof(findNextValue());
-
-				// Find pivot
-				for (int i = 0; i < 6; i++)
-					std::getline(fin, str_read);
-				fin.seekg(static_cast<size_t>(fin.tellg()) - (str_read.length() + 1));
-
-				// Find origin start
-				sf::Vector2f origin;
-				do {
-					fin.get(ch);
-				} while (ch != '{');
-
-				// Find values
-				origin.x = std::stof(findNextValue());
-				origin.y = std::stof(findNextValue());
-
-				data_->frames.emplace_back();
-				data_->frames.back().texture_rect = rect;
-				data_->frames.back().origin = origin;
-			}
-
-			if (data_->frames.empty())
-				std::cerr << "Unable to read file " << data_file << " using sprite file " << sprite_file << "\n";
-			fin.close();
-			finalizeAnimationSetup();
-		}
-		else
-			std::cerr << "Unable to open file: " << data_file << std::endl;
+		AnimationAtlas atlas;
+		if (atlas.loadFromFile(data_file))
+			loadFrames(atlas, sprite_file);
 	}
 
-	void Animation::updateNodeProperties()
+	void Animation::loadFrames(const AnimationAtlas& atlas, const std::string& sprite_file)
 	{
-		node_->setTextureRect(data_->frames[current_rect_].texture_rect);
+		Data* data = getWritableData();
+		if (data && data->loadFrames(atlas, sprite_file)) {
+			current_frame_ = 0;
+			playback_time_ = sf::Time::Zero;
+			updateNodeProperties();
+		}
+	}
 
-		const sf::FloatRect node_lbounds(node_->getLocalBounds());
-		const sf::Vector2f& node_origin = data_->frames[current_rect_].origin;
-		node_->setOrigin(node_origin.x * node_lbounds.width,
-			             node_origin.y * node_lbounds.height);
+	void Animation::loadFrames(const AnimationArchive& archive, const std::string& sprite_file)
+	{
+		Data* data = getWritableData();
+		if (data && data->loadFrames(archive, sprite_file)) {
+			current_frame_ = 0;
+			playback_time_ = sf::Time::Zero;
+			updateNodeProperties();
+		}
 	}
 
-	void Animation::finalizeAnimationSetup()
+	Animation::Data* Animation::getWritableData()
 	{
-		// Loopback animation (if needed)
-		if (data_->loopback)
-			for (int i = data_->frames.size() - 2; i >= 0; --i)
-				data_->frames.push_back(data_->frames[i]);
+		if (shared_data_) {
+			std::cerr << "Animation - Unable to load frames into shared animation data\n";
+			return nullptr;
+		}
+		// The data was handed over as mutable, only shared data is immutable
+		return const_cast<Data*>(data_);
+	}
 
-		// Calculate time per frame
-		const sf::Time frame_duration(sf::seconds(data_->total_duration.asSeconds() / data_->frames.size()));
-		for (auto& frame : data_->frames)
-			frame.duration = frame_duration;
+	void Animation::applyFrame(SpriteNode& node, const Frame& frame)
+	{
+		// A sprite's local bounds are the size of its texture rect, they're known without querying the node
+		const sf::IntRect rect(frame.texture_rect);
+		node.setTextureRect(frame.texture_rect);
+		node.setOrigin(frame.origin.x * std::abs(rect.width), frame.origin.y * std::abs(rect.height));
+	}
 
-		updateNodeProperties();
+	void Animation::updateNodeProperties()
+	{
+		applyFrame(*node_, data_->frames[current_frame_]);
 	}
 
 	void Animation::updateCurrent(sf::Time dt)
 	{
-		const bool reached_end = !(current_rect_ < data_->frames.size() - 1 || data_->repeat);
-
-		if (animation_ongoing_ && !reached_end && (elapsed_time_ += dt) >= data_->frames[current_rect_].duration) {
-			if (!reached_end || data_->repeat) {
-				updateNodeProperties();
-				elapsed_time_ = sf::Time::Zero;
-
-				if (data_->repeat) {
-					if (current_rect_ < data_->frames.size() - 1)
-						current_rect_++;
-					else
-						current_rect_ = 0;
-				}
-				else
-					current_rect_++;
-			}
-			else
-				animation_ongoing_ = false;
-		}
+		if (!animation_ongoing_)
+			return;
+
+		// The node is only updated once the frame changes
+		const unsigned previous_frame = current_frame_;
+		animation_ongoing_ = data_->step(current_frame_, playback_time_, dt);
+		if (current_frame_ != previous_frame)
+			updateNodeProperties();
+	}
+
+	void Animation::enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
 	}
 }
\ No newline at end of file
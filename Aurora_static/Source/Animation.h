@@ -1,6 +1,10 @@
 #ifndef Aurora_Animation_H_
 #define Aurora_Animation_H_
 
+#include <memory>
+
+#include "AnimationArchive.h"
+#include "AnimationAtlas.h"
 #include "SpriteNode.h"
 
 namespace au
@@ -15,18 +19,65 @@ namespace au
 			sf::Vector2f  origin;
 			sf::Time      duration;
 		};
-		/// <summary>Struct for an entire animation</summary>
+		/// <summary>
+		/// Struct for an entire animation<para/>
+		/// Looping back plays the frames forward, then backward down to the second frame if the animation repeats<para/>
+		/// (ping-pong) or to the first frame otherwise, frames are never copied
+		/// </summary>
 		struct Data {
-			std::vector<Frame> frames;
-			sf::Time           total_duration;
-			bool               repeat;
-			bool               loopback;
+			std::vector<Frame>    frames;
+			sf::Time              total_duration; // The cycle's duration once finalized
+			bool                  repeat;
+			bool                  loopback;
+			std::vector<sf::Time> frame_ends;     // Prefix sums of the frames' durations, computed by finalize
+
+			/// <summary>
+			/// Replaces the frames by the frames of an atlas, the frames' filenames are the sprites' filename followed<para/>
+			/// by the frame's number starting from 1 and the .png extension
+			/// </summary>
+			/// <param name="atlas">The atlas containing the animation's frames</param>
+			/// <param name="sprite_file">The sprites' filename (w/o the file extension)</param>
+			/// <returns>True if frames were found, false otherwise</returns>
+			bool loadFrames(const AnimationAtlas& atlas, const std::string& sprite_file);
+			/// <summary>
+			/// Replaces the frames by the frames of a compiled animation, along with its repeat and loopback flags<para/>
+			/// The frames are copied from the mapped file at once, their durations set the total duration if they're known
+			/// </summary>
+			/// <param name="archive">The opened archive containing the animation</param>
+			/// <param name="sprite_file">The sprites' filename (w/o the frame's number and file extension)</param>
+			/// <returns>True if the animation was found, false otherwise</returns>
+			bool loadFrames(const AnimationArchive& archive, const std::string& sprite_file);
+			/// <summary>
+			/// Computes the frames' end times, frames without a duration share the time left by the others evenly<para/>
+			/// The total duration is then set to the cycle's duration
+			/// </summary>
+			void finalize();
+			/// <summary>Returns the duration of a whole cycle, loopback included</summary>
+			/// <returns>The cycle's duration</returns>
+			sf::Time getCycleDuration() const;
+			/// <summary>Returns the frame played at a time, found by binary search</summary>
+			/// <param name="time">The time since the animation started, wrapped for repeating animations</param>
+			/// <returns>The frame's index</returns>
+			unsigned getFrameAt(sf::Time time) const;
+			/// <summary>Advances a playback position, in O(log n) whatever the time passed</summary>
+			/// <param name="frame">The current frame's index, set to the frame played at the new time</param>
+			/// <param name="time">The time within the cycle, advanced and wrapped or clamped to the cycle</param>
+			/// <param name="dt">Time passed in current frame</param>
+			/// <returns>False once an animation that doesn't repeat is over, true otherwise</returns>
+			bool step(unsigned& frame, sf::Time& time, sf::Time dt) const;
 		};
 	public:
 		/// <summary>Constructs the animation by providing the animation data and the sprite node</summary>
 		/// <param name="data">The animation data</param>
 		/// <param name="node">The node to be animated</param>
 		Animation(Data* data, SpriteNode* node);
+		/// <summary>
+		/// Constructs the animation by providing immutable animation data shared with other animations and the sprite node<para/>
+		/// The animation only stores its current frame and elapsed time, the data can't be loaded into
+		/// </summary>
+		/// <param name="data">The shared animation data (see AnimationLibrary), the animation has no frame if it's null</param>
+		/// <param name="node">The node to be animated</param>
+		Animation(std::shared_ptr<const Data> data, SpriteNode* node);
 		/// <summary>Constructs the animation by providing the json data, animation data and the sprite node</summary>
 		/// <param name="data_file">JSON data filepath</param>
 		/// <param name="sprite_file">The sprites' filename (w/o the file extension)</param>
@@ -34,6 +85,12 @@ namespace au
 		/// <param name="node">The node to be animated</param>
 		Animation(const std::string& data_file, const std::string& sprite_file,
 			      Data* data, SpriteNode* node);
+		/// <summary>Constructs the animation by providing a loaded atlas, animation data and the sprite node</summary>
+		/// <param name="atlas">The atlas containing the animation's frames</param>
+		/// <param name="sprite_file">The sprites' filename (w/o the file extension)</param>
+		/// <param name="data">The animation data</param>
+		/// <param name="node">The node to be animated</param>
+		Animation(const AnimationAtlas& atlas, const std::string& sprite_file, Data* data, SpriteNode* node);
 	public:
 		/// <summary>Starts the animation (no effect if animation is already ongoing)</summary>
 		/// <see cref="stop"/>
@@ -47,7 +104,10 @@ namespace au
 		/// <see cref="start"/>
 		/// <see cref="stop"/>
 		void restart();
-		/// <summary>Parses json animation file and inserts the data as frames</summary>
+		/// <summary>
+		/// Parses json animation file and replaces the frames by its data<para/>
+		/// The file is parsed again for every call, AnimationLibrary is preferred to load animations shared by several units
+		/// </summary>
 		/// <param name="data_file">JSON data filepath</param>
 		/// <param name="sprite_file">The sprites' filename (w/o the file extension)</param>
 		/// <example>
@@ -56,24 +116,59 @@ namespace au
 		/// </code>
 		/// </example>
 		void parseJsonFile(const std::string& data_file, const std::string& sprite_file);
+		/// <summary>
+		/// Replaces the frames by the frames of an atlas, the frames' filenames are the sprites' filename followed<para/>
+		/// by the frame's number starting from 1 and the .png extension
+		/// </summary>
+		/// <param name="atlas">The atlas containing the animation's frames</param>
+		/// <param name="sprite_file">The sprites' filename (w/o the file extension)</param>
+		/// <example>
+		/// <code>
+		/// loadFrames(atlas, "Knight_Walk"); // Knight_Walk1.png, Knight_Walk2.png, ...
+		/// </code>
+		/// </example>
+		void loadFrames(const AnimationAtlas& atlas, const std::string& sprite_file);
+		/// <summary>Replaces the frames by the frames of a compiled animation, along with its repeat and loopback flags</summary>
+		/// <param name="archive">The opened archive containing the animation</param>
+		/// <param name="sprite_file">The sprites' filename (w/o the frame's number and file extension)</param>
+		void loadFrames(const AnimationArchive& archive, const std::string& sprite_file);
+		/// <summary>Jumps to a time of the animation, seeking past the end of a repeating animation wraps around</summary>
+		/// <param name="time">The time since the animation started</param>
+		/// <see cref="getPlaybackTime"/>
+		void seek(sf::Time time);
+		/// <summary>Returns the time within the animation's cycle</summary>
+		/// <returns>The playback time</returns>
+		/// <see cref="seek"/>
+		inline sf::Time getPlaybackTime() const { return playback_time_; }
 		/// <summary>Checks if the animation is ongoing</summary>
 		/// <returns>True if it's ongoing, false otherwise</returns>
 		inline bool isOngoing() const { return animation_ongoing_; }
+		/// <summary>Sets a sprite node's texture rect and origin to a frame's</summary>
+		/// <param name="node">The sprite node</param>
+		/// <param name="frame">The frame</param>
+		static void applyFrame(SpriteNode& node, const Frame& frame);
 	private:
+		/// <summary>Returns the data the frames can be loaded into</summary>
+		/// <returns>The animation data, nullptr if the data is shared</returns>
+		Data* getWritableData();
 		/// <summary>Updates the node's properties (texture rect and origin)</summary>
 		void updateNodeProperties();
-		/// <summary>Adds in frames if the animation loops back and calculates the time per frame</summary>
-		void finalizeAnimationSetup();
 		/// <summary>Updates the node's animation</summary>
 		virtual void updateCurrent(sf::Time dt) override;
+		/// <summary>Animations don't draw anything, nothing is submitted to the render queue</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The node's render layer</param>
+		virtual void enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const override;
 
 	private:
-		Data*       data_;
-		SpriteNode* node_;
+		std::shared_ptr<const Data> shared_data_;
+		const Data*                 data_;
+		SpriteNode*                 node_;
 
-		unsigned    current_rect_;
-		sf::Time    elapsed_time_;
-		bool        animation_ongoing_;
+		unsigned                    current_frame_;
+		sf::Time                    playback_time_;
+		bool                        animation_ongoing_;
 	};
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,295 @@
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "AnimationArchive.h"
+
+namespace au
+{
+	namespace
+	{
+		/// <summary>First record of the file, the offsets are relative to the start of the file</summary>
+		struct Header
+		{
+			sf::Uint32 magic;
+			sf::Uint32 version;
+			sf::Uint32 animation_count;
+			sf::Uint32 frame_count;
+			sf::Uint32 animations_offset;
+			sf::Uint32 frames_offset;
+			sf::Uint32 names_offset;
+			sf::Uint32 names_size;
+		};
+
+		// "AUAN" once written in little-endian, files written in another byte order are rejected
+		const sf::Uint32 Magic = 0x4E415541;
+
+		static_assert(sizeof(Header) == 32, "The header's layout must not depend on the platform");
+		static_assert(sizeof(AnimationArchive::AnimationRecord) == 32, "The records' layout must not depend on the platform");
+		static_assert(sizeof(AnimationArchive::FrameRecord) == 32, "The records' layout must not depend on the platform");
+
+		/// <summary>Maps a whole file read-only</summary>
+		/// <param name="filename">The file's filepath</param>
+		/// <param name="size">Set to the file's size</param>
+		/// <returns>The mapped file, nullptr if it couldn't be mapped or is too small to be valid</returns>
+		const char* mapFile(const std::string& filename, size_t& size)
+		{
+#ifdef _WIN32
+			HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			                          FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return nullptr;
+
+			LARGE_INTEGER file_size;
+			const char* data = nullptr;
+			if (GetFileSizeEx(file, &file_size) && static_cast<size_t>(file_size.QuadPart) >= sizeof(Header)) {
+				size = static_cast<size_t>(file_size.QuadPart);
+				// The view keeps the mapping alive once its handle is closed
+				HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping) {
+					data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+					CloseHandle(mapping);
+				}
+			}
+			CloseHandle(file);
+			return data;
+#else
+			const int file = open(filename.c_str(), O_RDONLY);
+			if (file == -1)
+				return nullptr;
+
+			struct stat file_stat;
+			void* data = MAP_FAILED;
+			if (fstat(file, &file_stat) == 0 && static_cast<size_t>(file_stat.st_size) >= sizeof(Header)) {
+				size = static_cast<size_t>(file_stat.st_size);
+				data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+			}
+			close(file);
+			return data != MAP_FAILED ? static_cast<const char*>(data) : nullptr;
+#endif
+		}
+
+		void unmapFile(const char* data, size_t size)
+		{
+#ifdef _WIN32
+			(void)size;
+			UnmapViewOfFile(data);
+#else
+			munmap(const_cast<char*>(data), size);
+#endif
+		}
+
+		/// <summary>Splits a frame's filename into its sprites' filename and its number</summary>
+		/// <param name="filename">The frame's filename (e.g. "Knight_Walk12.png")</param>
+		/// <param name="name">Set to the sprites' filename (e.g. "Knight_Walk")</param>
+		/// <param name="number">Set to the frame's number (e.g. 12)</param>
+		/// <returns>True if the filename is numbered the way Animation::loadFrames expects, false otherwise</returns>
+		bool splitFrameFilename(const std::string& filename, std::string& name, sf::Uint32& number)
+		{
+			const std::string extension(".png");
+			if (filename.size() <= extension.size()
+				|| filename.compare(filename.size() - extension.size(), extension.size(), extension) != 0)
+				return false;
+
+			const size_t digits_end = filename.size() - extension.size();
+			size_t digits_begin = digits_end;
+			while (digits_begin > 0 && filename[digits_begin - 1] >= '0' && filename[digits_begin - 1] <= '9')
+				--digits_begin;
+			// Leading zeros aren't part of the names looked up, "Walk01.png" is never the first frame
+			if (digits_begin == digits_end || digits_end - digits_begin > 9 || filename[digits_begin] == '0')
+				return false;
+
+			name.assign(filename, 0, digits_begin);
+			number = static_cast<sf::Uint32>(std::stoul(filename.substr(digits_begin, digits_end - digits_begin)));
+			return true;
+		}
+	}
+
+	const sf::Uint32 AnimationArchive::Version;
+
+	AnimationArchive::AnimationArchive()
+		: data_(nullptr)
+		, size_(0)
+		, animations_(nullptr)
+		, animation_count_(0)
+		, frames_(nullptr)
+		, names_(nullptr)
+	{
+	}
+
+	AnimationArchive::~AnimationArchive()
+	{
+		close();
+	}
+
+	bool AnimationArchive::openFromFile(const std::string& filename)
+	{
+		close();
+
+		data_ = mapFile(filename, size_);
+		if (!data_) {
+			std::cerr << "Unable to open file: " << filename << std::endl;
+			return false;
+		}
+		if (!validate()) {
+			std::cerr << "AnimationArchive::openFromFile - Invalid or outdated compiled file " << filename << "\n";
+			close();
+			return false;
+		}
+
+		const Header* header = reinterpret_cast<const Header*>(data_);
+		animations_ = reinterpret_cast<const AnimationRecord*>(data_ + header->animations_offset);
+		animation_count_ = header->animation_count;
+		frames_ = reinterpret_cast<const FrameRecord*>(data_ + header->frames_offset);
+		names_ = data_ + header->names_offset;
+		return true;
+	}
+
+	void AnimationArchive::close()
+	{
+		if (data_)
+			unmapFile(data_, size_);
+
+		data_ = nullptr;
+		size_ = 0;
+		animations_ = nullptr;
+		animation_count_ = 0;
+		frames_ = nullptr;
+		names_ = nullptr;
+	}
+
+	bool AnimationArchive::findAnimation(const std::string& name, View& view) const
+	{
+		// The animations are sorted by name when compiled
+		size_t first = 0, last = animation_count_;
+		while (first < last) {
+			const size_t middle = first + (last - first) / 2;
+			const AnimationRecord& animation = animations_[middle];
+			const int comparison = name.compare(0, std::string::npos, names_ + animation.name_offset, animation.name_length);
+			if (comparison == 0) {
+				view.frames = frames_ + animation.first_frame;
+				view.frame_count = animation.frame_count;
+				view.total_duration = sf::microseconds(animation.total_duration);
+				view.flags = animation.flags;
+				return true;
+			}
+			if (comparison < 0)
+				last = middle;
+			else
+				first = middle + 1;
+		}
+		return false;
+	}
+
+	bool AnimationArchive::View::isTimed() const
+	{
+		for (size_t i = 0; i < frame_count; ++i)
+			if (frames[i].duration <= 0)
+				return false;
+		return true;
+	}
+
+	bool AnimationArchive::compile(const AnimationAtlas& atlas, const std::string& filename, sf::Uint32 default_flags,
+		                           const std::unordered_map<std::string, sf::Uint32>& flags)
+	{
+		// Ordered containers sort the animations by name and their frames by number
+		std::map<std::string, std::map<sf::Uint32, const AnimationAtlas::Region*>> animations;
+		std::string name;
+		sf::Uint32 number;
+		for (const auto& region : atlas.getRegions())
+			if (splitFrameFilename(region.first, name, number))
+				animations[name][number] = &region.second;
+
+		std::vector<AnimationRecord> animation_records;
+		std::vector<FrameRecord> frame_records;
+		std::string names;
+		for (const auto& animation : animations) {
+			AnimationRecord record = {};
+			record.name_offset = static_cast<sf::Uint32>(names.size());
+			record.name_length = static_cast<sf::Uint32>(animation.first.size());
+			record.first_frame = static_cast<sf::Uint32>(frame_records.size());
+			const auto found_flags = flags.find(animation.first);
+			record.flags = found_flags != flags.end() ? found_flags->second : default_flags;
+
+			// Like Animation::loadFrames, the animation stops at the first missing number
+			for (auto frame = animation.second.find(1); frame != animation.second.end() && frame->first == record.frame_count + 1;
+				 ++frame, ++record.frame_count) {
+				const AnimationAtlas::Region& region = *frame->second;
+				FrameRecord frame_record = {};
+				frame_record.texture_rect[0] = region.texture_rect.left;
+				frame_record.texture_rect[1] = region.texture_rect.top;
+				frame_record.texture_rect[2] = region.texture_rect.width;
+				frame_record.texture_rect[3] = region.texture_rect.height;
+				frame_record.origin[0] = region.origin.x;
+				frame_record.origin[1] = region.origin.y;
+				frame_record.duration = region.duration.asMicroseconds();
+				frame_records.push_back(frame_record);
+				record.total_duration += frame_record.duration;
+			}
+
+			if (record.frame_count > 0) {
+				names += animation.first;
+				animation_records.push_back(record);
+			}
+		}
+
+		Header header = {};
+		header.magic = Magic;
+		header.version = Version;
+		header.animation_count = static_cast<sf::Uint32>(animation_records.size());
+		header.frame_count = static_cast<sf::Uint32>(frame_records.size());
+		header.animations_offset = sizeof(Header);
+		header.frames_offset = header.animations_offset + header.animation_count * sizeof(AnimationRecord);
+		header.names_offset = header.frames_offset + header.frame_count * sizeof(FrameRecord);
+		header.names_size = static_cast<sf::Uint32>(names.size());
+
+		std::ofstream fout(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!fout.is_open()) {
+			std::cerr << "Unable to open file: " << filename << std::endl;
+			return false;
+		}
+		fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		fout.write(reinterpret_cast<const char*>(animation_records.data()), animation_records.size() * sizeof(AnimationRecord));
+		fout.write(reinterpret_cast<const char*>(frame_records.data()), frame_records.size() * sizeof(FrameRecord));
+		fout.write(names.data(), names.size());
+		return static_cast<bool>(fout);
+	}
+
+	bool AnimationArchive::validate() const
+	{
+		const Header* header = reinterpret_cast<const Header*>(data_);
+		if (header->magic != Magic || header->version != Version)
+			return false;
+
+		// 64-bit arithmetic so that corrupted offsets and counts can't overflow
+		const sf::Uint64 size = size_;
+		const sf::Uint64 animations_end = header->animations_offset + sf::Uint64(header->animation_count) * sizeof(AnimationRecord);
+		const sf::Uint64 frames_end = header->frames_offset + sf::Uint64(header->frame_count) * sizeof(FrameRecord);
+		if (header->animations_offset % 8 != 0 || header->frames_offset % 8 != 0 || animations_end > size || frames_end > size
+			|| sf::Uint64(header->names_offset) + header->names_size > size)
+			return false;
+
+		const AnimationRecord* animations = reinterpret_cast<const AnimationRecord*>(data_ + header->animations_offset);
+		for (size_t i = 0; i < header->animation_count; ++i)
+			if (sf::Uint64(animations[i].name_offset) + animations[i].name_length > header->names_size
+				|| sf::Uint64(animations[i].first_frame) + animations[i].frame_count > header->frame_count)
+				return false;
+		return true;
+	}
+}
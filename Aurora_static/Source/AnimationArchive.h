@@ -0,0 +1,124 @@
+#ifndef Aurora_AnimationArchive_H_
+#define Aurora_AnimationArchive_H_
+
+#include <string>
+#include <unordered_map>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include "AnimationAtlas.h"
+
+namespace au
+{
+	/// <summary>
+	/// Compiled binary animation file, memory-mapped and read in place without any parsing<para/>
+	/// The file is versioned and made of fixed-size records aligned on 8 bytes: a header, the animations sorted<para/>
+	/// by name, the frames of every animation stored contiguously and the animations' names<para/>
+	/// Opening a file only validates its header and animation records, animations are then found by binary search<para/>
+	/// and their frames are views into the mapped file<para/>
+	/// Files are compiled from a TexturePacker JSON atlas with the compile method or the Aurora_animation_compiler tool,<para/>
+	/// they're written in the native byte order of little-endian platforms
+	/// </summary>
+	/// <example>
+	/// <code>
+	/// au::AnimationArchive archive;
+	/// archive.openFromFile("Assets/TextureData/KnightData.auanim");
+	/// walk_animation.loadFrames(archive, "Knight_Walk");
+	/// </code>
+	/// </example>
+	class AnimationArchive : private sf::NonCopyable
+	{
+	public:
+		/// <summary>Per-animation flags</summary>
+		enum Flags : sf::Uint32
+		{
+			Repeat   = 1 << 0, // The animation restarts once over
+			Loopback = 1 << 1  // The animation plays back in reverse once over
+		};
+
+		/// <summary>Frame as stored in the file</summary>
+		struct FrameRecord
+		{
+			float     texture_rect[4]; // Left, top, width and height
+			float     origin[2];       // Relative to the frame's size
+			sf::Int64 duration;        // In microseconds, zero if the atlas didn't specify it
+		};
+
+		/// <summary>Animation as stored in the file</summary>
+		struct AnimationRecord
+		{
+			sf::Uint32 name_offset;    // Relative to the names block
+			sf::Uint32 name_length;
+			sf::Uint32 first_frame;
+			sf::Uint32 frame_count;
+			sf::Uint32 flags;
+			sf::Uint32 padding;
+			sf::Int64  total_duration; // In microseconds, the sum of the frames' durations
+		};
+
+		/// <summary>View of an animation's frames inside the mapped file</summary>
+		struct View
+		{
+			const FrameRecord* frames;
+			size_t             frame_count;
+			sf::Time           total_duration;
+			sf::Uint32         flags;
+
+			/// <summary>Checks if every frame has its own duration, the animation's total duration is then fixed</summary>
+			/// <returns>True if no frame's duration is zero, false otherwise</returns>
+			bool isTimed() const;
+		};
+
+		/// <summary>Current version of the file format</summary>
+		static const sf::Uint32 Version = 1;
+
+	public:
+		/// <summary>Constructs an empty archive</summary>
+		AnimationArchive();
+		/// <summary>Unmaps the file</summary>
+		~AnimationArchive();
+	public:
+		/// <summary>Memory-maps a compiled file, closing the file already opened</summary>
+		/// <param name="filename">Compiled file's filepath</param>
+		/// <returns>True if the file was opened and is valid, false otherwise</returns>
+		/// <see cref="close"/>
+		bool openFromFile(const std::string& filename);
+		/// <summary>Unmaps the file, the views previously returned become invalid</summary>
+		/// <see cref="openFromFile"/>
+		void close();
+		/// <summary>Finds an animation</summary>
+		/// <param name="name">The animation's name, the sprites' filename (w/o the frame's number and file extension)</param>
+		/// <param name="view">The view set to the animation's frames if it's found</param>
+		/// <returns>True if the archive contains the animation, false otherwise</returns>
+		bool findAnimation(const std::string& name, View& view) const;
+		/// <summary>Returns the amount of animations of the archive</summary>
+		/// <returns>The amount of animations</returns>
+		inline size_t getAnimationCount() const { return animation_count_; }
+		/// <summary>
+		/// Compiles the animations of an atlas into a file, the frames named after a sprites' filename followed<para/>
+		/// by consecutive numbers starting from 1 and the .png extension make up an animation
+		/// </summary>
+		/// <param name="atlas">The atlas containing the animations' frames</param>
+		/// <param name="filename">The compiled file's filepath</param>
+		/// <param name="default_flags">The flags of the animations that aren't overridden</param>
+		/// <param name="flags">The flags of specific animations, indexed by name</param>
+		/// <returns>True if the file was written, false otherwise</returns>
+		static bool compile(const AnimationAtlas& atlas, const std::string& filename, sf::Uint32 default_flags = Repeat,
+			                const std::unordered_map<std::string, sf::Uint32>& flags = {});
+	private:
+		/// <summary>Checks that the records of the mapped file stay inside it</summary>
+		/// <returns>True if the file is valid, false otherwise</returns>
+		bool validate() const;
+
+	private:
+		const char*            data_;
+		size_t                 size_;
+		const AnimationRecord* animations_;
+		size_t                 animation_count_;
+		const FrameRecord*     frames_;
+		const char*            names_;
+	};
+}
+#endif
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "AnimationAtlas.h"
+
+namespace au
+{
+	namespace
+	{
+		/// <summary>Single-pass tokenizer of JSON data, values that aren't needed are skipped without being stored</summary>
+		class JsonReader
+		{
+		public:
+			JsonReader(const char* begin, const char* end)
+				: current_(begin)
+				, begin_(begin)
+				, end_(end)
+				, failed_(false)
+			{
+			}
+
+			inline bool hasFailed() const { return failed_; }
+			inline size_t getOffset() const { return static_cast<size_t>(current_ - begin_); }
+
+			/// <summary>Returns the next significant character without consuming it, '\0' at the end of the data</summary>
+			char peek()
+			{
+				while (current_ != end_ && (*current_ == ' ' || *current_ == '\t' || *current_ == '\n' || *current_ == '\r'))
+					++current_;
+				return current_ != end_ ? *current_ : '\0';
+			}
+
+			/// <summary>Consumes the next significant character, the reader fails if it isn't the one expected</summary>
+			bool expect(char ch)
+			{
+				if (peek() != ch)
+					return fail();
+				++current_;
+				return true;
+			}
+
+			bool readString(std::string& value)
+			{
+				value.clear();
+				if (!expect('"'))
+					return false;
+
+				while (current_ != end_ && *current_ != '"') {
+					char ch = *current_++;
+					if (ch == '\\' && current_ != end_) {
+						ch = *current_++;
+						switch (ch) {
+						case 'n': ch = '\n'; break;
+						case 't': ch = '\t'; break;
+						case 'r': ch = '\r'; break;
+						case 'b': ch = '\b'; break;
+						case 'f': ch = '\f'; break;
+						case 'u':
+							// Non-ASCII characters aren't expected in filenames, the code point is dropped
+							current_ += std::min<size_t>(4, end_ - current_);
+							continue;
+						default: break;
+						}
+					}
+					value += ch;
+				}
+				return expect('"');
+			}
+
+			bool readNumber(float& value)
+			{
+				// The number is copied so that strtof never reads past the end of data that isn't null-terminated
+				peek();
+				char number[32];
+				size_t length = 0;
+				while (current_ + length != end_ && length < sizeof(number) - 1 && isNumberCharacter(current_[length])) {
+					number[length] = current_[length];
+					++length;
+				}
+				number[length] = '\0';
+
+				char* number_end = nullptr;
+				value = std::strtof(number, &number_end);
+				if (number_end == number)
+					return fail();
+				current_ += number_end - number;
+				return true;
+			}
+
+			/// <summary>Calls a function for every key of an object, the function must read or skip the key's value</summary>
+			template <typename Function>
+			bool readObject(Function on_key)
+			{
+				if (!expect('{'))
+					return false;
+				if (peek() == '}')
+					return expect('}');
+
+				std::string key;
+				do {
+					if (!readString(key) || !expect(':') || !on_key(key))
+						return false;
+				} while (peek() == ',' && expect(','));
+				return expect('}');
+			}
+
+			/// <summary>Calls a function for every element of an array, the function must read or skip the element</summary>
+			template <typename Function>
+			bool readArray(Function on_element)
+			{
+				if (!expect('['))
+					return false;
+				if (peek() == ']')
+					return expect(']');
+
+				do {
+					if (!on_element())
+						return false;
+				} while (peek() == ',' && expect(','));
+				return expect(']');
+			}
+
+			bool skipValue()
+			{
+				std::string ignored;
+				switch (peek()) {
+				case '{':
+					return readObject([this](const std::string&) { return skipValue(); });
+				case '[':
+					return readArray([this]() { return skipValue(); });
+				case '"':
+					return readString(ignored);
+				case 't':
+					return skipLiteral("true");
+				case 'f':
+					return skipLiteral("false");
+				case 'n':
+					return skipLiteral("null");
+				default:
+					float number;
+					return readNumber(number);
+				}
+			}
+
+		private:
+			static inline bool isNumberCharacter(char ch)
+			{
+				return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+			}
+
+			bool skipLiteral(const char* literal)
+			{
+				for (; *literal; ++literal, ++current_)
+					if (current_ == end_ || *current_ != *literal)
+						return fail();
+				return true;
+			}
+
+			inline bool fail()
+			{
+				failed_ = true;
+				return false;
+			}
+
+		private:
+			const char* current_;
+			const char* begin_;
+			const char* end_;
+			bool        failed_;
+		};
+
+		/// <summary>Reads the rectangle or the point of a frame's "frame" or "pivot" key</summary>
+		bool readFrameValues(JsonReader& reader, float& x, float& y, float* w, float* h)
+		{
+			return reader.readObject([&](const std::string& key) {
+				if (key == "x")
+					return reader.readNumber(x);
+				if (key == "y")
+					return reader.readNumber(y);
+				if (key == "w" && w)
+					return reader.readNumber(*w);
+				if (key == "h" && h)
+					return reader.readNumber(*h);
+				return reader.skipValue();
+			});
+		}
+
+		/// <summary>Reads a frame's object, its filename is the hash key or its "filename" key</summary>
+		bool readFrame(JsonReader& reader, std::string& name, AnimationAtlas::Region& region)
+		{
+			// TexturePacker's default pivot is the frame's center
+			region.origin = sf::Vector2f(0.5f, 0.5f);
+			region.duration = sf::Time::Zero;
+			return reader.readObject([&](const std::string& key) {
+				sf::FloatRect& rect = region.texture_rect;
+				if (key == "filename")
+					return reader.readString(name);
+				if (key == "frame")
+					return readFrameValues(reader, rect.left, rect.top, &rect.width, &rect.height);
+				if (key == "pivot")
+					return readFrameValues(reader, region.origin.x, region.origin.y, nullptr, nullptr);
+				if (key == "duration") {
+					float milliseconds;
+					if (!reader.readNumber(milliseconds))
+						return false;
+					region.duration = sf::milliseconds(static_cast<sf::Int32>(milliseconds));
+					return true;
+				}
+				return reader.skipValue();
+			});
+		}
+	}
+
+	bool AnimationAtlas::loadFromFile(const std::string& filename)
+	{
+		std::ifstream fin(filename, std::ios::in | std::ios::binary);
+		if (!fin.is_open()) {
+			std::cerr << "Unable to open file: " << filename << std::endl;
+			return false;
+		}
+
+		const std::string data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+		if (!loadFromMemory(data.c_str(), data.size())) {
+			std::cerr << "Unable to read file " << filename << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool AnimationAtlas::loadFromMemory(const char* data, size_t size)
+	{
+		regions_.clear();
+		image_.clear();
+
+		JsonReader reader(data, data + size);
+		std::string name;
+		Region region;
+		reader.readObject([&](const std::string& key) {
+			if (key == "frames") {
+				if (reader.peek() == '[')
+					return reader.readArray([&]() {
+						name.clear();
+						if (!readFrame(reader, name, region))
+							return false;
+						regions_[name] = region;
+						return true;
+					});
+				return reader.readObject([&](const std::string& frame_name) {
+					name = frame_name;
+					if (!readFrame(reader, name, region))
+						return false;
+					regions_[name] = region;
+					return true;
+				});
+			}
+			if (key == "meta")
+				return reader.readObject([&](const std::string& meta_key) {
+					return meta_key == "image" ? reader.readString(image_) : reader.skipValue();
+				});
+			return reader.skipValue();
+		});
+
+		if (reader.hasFailed()) {
+			std::cerr << "AnimationAtlas::loadFromMemory - Invalid JSON at offset " << reader.getOffset() << "\n";
+			regions_.clear();
+			return false;
+		}
+		return true;
+	}
+
+	const AnimationAtlas::Region* AnimationAtlas::findRegion(const std::string& name) const
+	{
+		const auto found = regions_.find(name);
+		return found != regions_.end() ? &found->second : nullptr;
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef Aurora_AnimationAtlas_H_
+#define Aurora_AnimationAtlas_H_
+
+#include <string>
+#include <unordered_map>
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Time.hpp>
+#include <SFML/System/Vector2.hpp>
+
+namespace au
+{
+	/// <summary>
+	/// Frames of a TexturePacker JSON sprite sheet (array or hash format), indexed by filename<para/>
+	/// The file is read at once and tokenized in a single pass, every animation of the sprite sheet is then<para/>
+	/// loaded from the atlas without parsing the file again<para/>
+	/// Can be stored in a ResourceHolder
+	/// </summary>
+	/// <example>
+	/// <code>
+	/// au::AnimationAtlas atlas;
+	/// atlas.loadFromFile("Assets/TextureData/KnightData.json");
+	/// walk_animation.loadFrames(atlas, "Knight_Walk");
+	/// attack_animation.loadFrames(atlas, "Knight_Attack");
+	/// </code>
+	/// </example>
+	class AnimationAtlas
+	{
+	public:
+		/// <summary>Sub-rectangle of the sprite sheet, relative origin and duration of a frame</summary>
+		struct Region
+		{
+			sf::FloatRect texture_rect;
+			sf::Vector2f  origin;       // Relative to the frame's size, the frame's pivot
+			sf::Time      duration;     // The frame's "duration" key (in milliseconds), zero if the atlas doesn't specify it
+		};
+
+	public:
+		/// <summary>Loads the atlas from a JSON file, replacing the frames already loaded</summary>
+		/// <param name="filename">JSON data filepath</param>
+		/// <returns>True if the file was loaded, false otherwise</returns>
+		bool loadFromFile(const std::string& filename);
+		/// <summary>Loads the atlas from JSON data in memory, replacing the frames already loaded</summary>
+		/// <param name="data">The JSON data</param>
+		/// <param name="size">The size of the data in bytes</param>
+		/// <returns>True if the data was loaded, false otherwise</returns>
+		bool loadFromMemory(const char* data, size_t size);
+		/// <summary>Returns the region of a frame</summary>
+		/// <param name="name">The frame's filename (e.g. "Knight_Walk1.png")</param>
+		/// <returns>The frame's region, nullptr if the atlas doesn't contain the frame</returns>
+		const Region* findRegion(const std::string& name) const;
+		/// <summary>Returns the amount of frames of the atlas</summary>
+		/// <returns>The amount of frames</returns>
+		inline size_t getRegionCount() const { return regions_.size(); }
+		/// <summary>Returns the regions of every frame</summary>
+		/// <returns>The regions indexed by the frames' filenames</returns>
+		inline const std::unordered_map<std::string, Region>& getRegions() const { return regions_; }
+		/// <summary>Returns the sprite sheet's image filename</summary>
+		/// <returns>The image's filename, empty if the atlas doesn't specify it</returns>
+		inline const std::string& getImage() const { return image_; }
+
+	private:
+		std::unordered_map<std::string, Region> regions_;
+		std::string                             image_;
+	};
+}
+#endif
@@ -0,0 +1,94 @@
+#include <limits>
+
+#include "AnimationLibrary.h"
+
+namespace au
+{
+	AnimationLibrary::AnimationLibrary()
+		: animations_()
+		, atlases_()
+		, archives_()
+	{
+	}
+
+	AnimationLibrary::DataPtr AnimationLibrary::load(const std::string& data_file, const std::string& sprite_file,
+		                                             sf::Time total_duration, bool repeat, bool loopback)
+	{
+		if (!isArchive(data_file)) {
+			const Key key(data_file, sprite_file, total_duration.asMicroseconds(), repeat, loopback);
+			const auto found = animations_.find(key);
+			if (found != animations_.end())
+				return found->second;
+
+			// Files that failed to load are remembered too so that they aren't read again for each animation
+			auto atlas = atlases_.find(data_file);
+			if (atlas == atlases_.end()) {
+				auto loaded_atlas(std::make_unique<AnimationAtlas>());
+				if (!loaded_atlas->loadFromFile(data_file))
+					loaded_atlas.reset();
+				atlas = atlases_.emplace(data_file, std::move(loaded_atlas)).first;
+			}
+
+			auto data(std::make_shared<Animation::Data>());
+			data->total_duration = total_duration;
+			data->repeat = repeat;
+			data->loopback = loopback;
+			if (!atlas->second || !data->loadFrames(*atlas->second, sprite_file))
+				return nullptr;
+			animations_.emplace(key, data);
+			return data;
+		}
+
+		auto archive = archives_.find(data_file);
+		if (archive == archives_.end()) {
+			auto opened_archive(std::make_unique<AnimationArchive>());
+			if (!opened_archive->openFromFile(data_file))
+				opened_archive.reset();
+			archive = archives_.emplace(data_file, std::move(opened_archive)).first;
+		}
+
+		// Compiled animations have their own flags, the total duration requested only matters if a frame is untimed
+		AnimationArchive::View view;
+		const bool found_animation = archive->second && archive->second->findAnimation(sprite_file, view);
+		const Key key(data_file, sprite_file, found_animation && !view.isTimed() ? total_duration.asMicroseconds() : 0,
+		              false, false);
+		const auto found = animations_.find(key);
+		if (found != animations_.end())
+			return found->second;
+
+		auto data(std::make_shared<Animation::Data>());
+		data->total_duration = total_duration;
+		if (!archive->second || !data->loadFrames(*archive->second, sprite_file))
+			return nullptr;
+		animations_.emplace(key, data);
+		return data;
+	}
+
+	AnimationLibrary::DataPtr AnimationLibrary::find(const std::string& data_file, const std::string& sprite_file) const
+	{
+		// The keys of an animation are ordered by settings after its files, the lowest comes first
+		const auto found = animations_.lower_bound(Key(data_file, sprite_file, std::numeric_limits<sf::Int64>::min(), false, false));
+		if (found == animations_.end() || std::get<0>(found->first) != data_file || std::get<1>(found->first) != sprite_file)
+			return nullptr;
+		return found->second;
+	}
+
+	void AnimationLibrary::releaseFiles()
+	{
+		atlases_.clear();
+		archives_.clear();
+	}
+
+	void AnimationLibrary::clear()
+	{
+		releaseFiles();
+		animations_.clear();
+	}
+
+	bool AnimationLibrary::isArchive(const std::string& data_file)
+	{
+		const std::string extension(".auanim");
+		return data_file.size() > extension.size()
+			&& data_file.compare(data_file.size() - extension.size(), extension.size(), extension) == 0;
+	}
+}
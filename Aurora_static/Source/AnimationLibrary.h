@@ -0,0 +1,84 @@
+#ifndef Aurora_AnimationLibrary_H_
+#define Aurora_AnimationLibrary_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+#include <SFML/System/NonCopyable.hpp>
+
+#include "Animation.h"
+
+namespace au
+{
+	/// <summary>
+	/// Cache of immutable animation data shared by every animation of the same sprites, keyed by data file, sprites' filename<para/>
+	/// and playback settings (only the total duration of compiled animations with untimed frames, they have their own flags)<para/>
+	/// Each data file is parsed (JSON atlas) or mapped (compiled archive, see AnimationArchive) once, no matter how many<para/>
+	/// animations are loaded from it, and each animation's frames are stored once no matter how many units play it<para/>
+	/// Files are kept loaded until released, the cached data lives on as long as an animation holds it
+	/// </summary>
+	/// <example>
+	/// <code>
+	/// au::AnimationLibrary library;
+	/// auto walk(library.load("Assets/TextureData/KnightData.json", "Knight_Walk", sf::seconds(0.8f)));
+	/// for (auto& knight : knights)
+	///     knight.attachChild(std::make_unique&lt;au::Animation&gt;(walk, knight.getSprite()));
+	/// library.releaseFiles();
+	/// </code>
+	/// </example>
+	class AnimationLibrary : private sf::NonCopyable
+	{
+	public:
+		using DataPtr = std::shared_ptr<const Animation::Data>;
+
+	public:
+		/// <summary>Constructs an empty library</summary>
+		AnimationLibrary();
+	public:
+		/// <summary>
+		/// Returns the data of an animation, loading it the first time it's requested with the same playback settings<para/>
+		/// Compiled animations use their own flags, the total duration requested is only used (and keyed) if one of<para/>
+		/// their frames has no duration, animations whose frames are all timed are loaded once whatever the settings
+		/// </summary>
+		/// <param name="data_file">JSON atlas or compiled archive filepath (.auanim extension)</param>
+		/// <param name="sprite_file">The sprites' filename (w/o the frame's number and file extension)</param>
+		/// <param name="total_duration">The duration of the whole animation</param>
+		/// <param name="repeat">True if the animation restarts once over, false otherwise</param>
+		/// <param name="loopback">True if the animation plays back in reverse once over, false otherwise</param>
+		/// <returns>The shared animation data, nullptr if the file or the animation couldn't be found</returns>
+		DataPtr load(const std::string& data_file, const std::string& sprite_file, sf::Time total_duration,
+			         bool repeat = true, bool loopback = false);
+		/// <summary>Returns the data of an animation that was already loaded, whatever its playback settings</summary>
+		/// <param name="data_file">The data file's filepath</param>
+		/// <param name="sprite_file">The sprites' filename</param>
+		/// <returns>The shared animation data loaded first, nullptr if the animation wasn't loaded</returns>
+		DataPtr find(const std::string& data_file, const std::string& sprite_file) const;
+		/// <summary>Returns the amount of animations cached</summary>
+		/// <returns>The amount of animations</returns>
+		inline size_t getAnimationCount() const { return animations_.size(); }
+		/// <summary>Returns the amount of data files kept loaded</summary>
+		/// <returns>The amount of files</returns>
+		inline size_t getFileCount() const { return atlases_.size() + archives_.size(); }
+		/// <summary>Releases the parsed atlases and unmaps the archives, the cached animation data is kept</summary>
+		void releaseFiles();
+		/// <summary>Releases the files and the library's references to the animation data</summary>
+		void clear();
+	private:
+		/// <summary>Data file, sprites' filename, total duration (in microseconds), repeat and loopback</summary>
+		using Key = std::tuple<std::string, std::string, sf::Int64, bool, bool>;
+
+		/// <summary>Checks if a data file is a compiled archive</summary>
+		/// <param name="data_file">The data file's filepath</param>
+		/// <returns>True if the file has the .auanim extension, false otherwise</returns>
+		static bool isArchive(const std::string& data_file);
+
+	private:
+		std::map<Key, DataPtr>                                             animations_;
+		std::unordered_map<std::string, std::unique_ptr<AnimationAtlas>>   atlases_;   // Null if the file couldn't be read
+		std::unordered_map<std::string, std::unique_ptr<AnimationArchive>> archives_;  // Null if the file couldn't be mapped
+	};
+}
+#endif
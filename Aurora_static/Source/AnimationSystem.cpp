@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cassert>
+
+#include "AnimationSystem.h"
+
+namespace au
+{
+	const AnimationSystem::AnimationId AnimationSystem::NullAnimation;
+
+	AnimationSystem::AnimationSystem()
+		: states_()
+		, nodes_()
+		, free_animations_()
+		, data_()
+		, changed_()
+		, frame_changes_(0)
+	{
+		setEventSubscriptions({});
+	}
+
+	AnimationSystem::AnimationId AnimationSystem::add(std::shared_ptr<const Animation::Data> data, SpriteNode& node, bool play)
+	{
+		// The library returns null data for animations that couldn't be loaded
+		if (!data || data->frames.empty())
+			return NullAnimation;
+		assert(data->frame_ends.size() == data->frames.size());
+
+		AnimationId animation;
+		if (!free_animations_.empty()) {
+			animation = free_animations_.back();
+			free_animations_.pop_back();
+		}
+		else {
+			animation = static_cast<AnimationId>(states_.size());
+			states_.emplace_back();
+			nodes_.emplace_back();
+		}
+
+		State& state = states_[animation];
+		state.data = data.get();
+		state.time = sf::Time::Zero;
+		state.frame = 0;
+		state.playing = play;
+		state.alive = true;
+		nodes_[animation] = node.getHandle();
+		data_.emplace(data.get(), std::move(data));
+
+		applyFrame(animation);
+		return animation;
+	}
+
+	void AnimationSystem::remove(AnimationId animation)
+	{
+		if (!isValid(animation))
+			return;
+
+		states_[animation].playing = false;
+		states_[animation].alive = false;
+		nodes_[animation] = SceneNode::Handle();
+		free_animations_.push_back(animation);
+	}
+
+	void AnimationSystem::play(AnimationId animation)
+	{
+		if (isValid(animation))
+			states_[animation].playing = true;
+	}
+
+	void AnimationSystem::stop(AnimationId animation)
+	{
+		if (isValid(animation))
+			states_[animation].playing = false;
+	}
+
+	void AnimationSystem::restart(AnimationId animation)
+	{
+		if (!isValid(animation))
+			return;
+
+		states_[animation].time = sf::Time::Zero;
+		states_[animation].playing = true;
+		if (states_[animation].frame != 0) {
+			states_[animation].frame = 0;
+			applyFrame(animation);
+		}
+	}
+
+	void AnimationSystem::seek(AnimationId animation, sf::Time time)
+	{
+		if (!isValid(animation))
+			return;
+
+		State& state = states_[animation];
+		const unsigned previous_frame = state.frame;
+		state.time = sf::Time::Zero;
+		state.playing = state.data->step(state.frame, state.time, std::max(time, sf::Time::Zero));
+		if (state.frame != previous_frame)
+			applyFrame(animation);
+	}
+
+	bool AnimationSystem::isPlaying(AnimationId animation) const
+	{
+		return isValid(animation) && states_[animation].playing;
+	}
+
+	unsigned AnimationSystem::getFrame(AnimationId animation) const
+	{
+		return isValid(animation) ? states_[animation].frame : 0;
+	}
+
+	bool AnimationSystem::isValid(AnimationId animation) const
+	{
+		return animation >= 0 && static_cast<size_t>(animation) < states_.size() && states_[animation].alive;
+	}
+
+	void AnimationSystem::applyFrame(AnimationId animation)
+	{
+		SpriteNode* node = static_cast<SpriteNode*>(SceneNode::resolve(nodes_[animation]));
+		if (node)
+			Animation::applyFrame(*node, states_[animation].data->frames[states_[animation].frame]);
+		else
+			remove(animation);
+	}
+
+	void AnimationSystem::updateCurrent(sf::Time dt)
+	{
+		// The stepping loop only reads the playback states, the nodes are resolved afterwards for the frames that changed
+		changed_.clear();
+		for (size_t i = 0; i < states_.size(); ++i) {
+			State& state = states_[i];
+			if (!state.playing)
+				continue;
+
+			const unsigned previous_frame = state.frame;
+			state.playing = state.data->step(state.frame, state.time, dt);
+			if (state.frame != previous_frame)
+				changed_.push_back(static_cast<AnimationId>(i));
+		}
+
+		frame_changes_ = changed_.size();
+		for (AnimationId animation : changed_)
+			applyFrame(animation);
+	}
+}
@@ -0,0 +1,113 @@
+#ifndef Aurora_AnimationSystem_H_
+#define Aurora_AnimationSystem_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/Config.hpp>
+
+#include "Animation.h"
+
+namespace au
+{
+	/// <summary>
+	/// SceneNode derivative stepping many animations of sprite nodes in a single loop over contiguous playback states<para/>
+	/// Each animation only stores its data, its current frame, its playback time and whether it's playing, the animation<para/>
+	/// data being shared (see AnimationLibrary), frames are found by binary search whatever the time step<para/>
+	/// The sprite nodes are only resolved and updated once their frame changes, the animations of destroyed nodes<para/>
+	/// are removed then
+	/// </summary>
+	/// <example>
+	/// <code>
+	/// auto animations(std::make_unique&lt;au::AnimationSystem&gt;());
+	/// for (auto& knight : knights)
+	///     animations->add(library.load("Assets/TextureData/KnightData.json", "Knight_Walk", sf::seconds(0.8f)), knight);
+	/// scene.attachChild(std::move(animations));
+	/// </code>
+	/// </example>
+	class AnimationSystem : public SceneNode
+	{
+	public:
+		using AnimationId = sf::Int32;
+		/// <summary>Value used for invalid animations</summary>
+		static const AnimationId NullAnimation = -1;
+
+	public:
+		/// <summary>Constructs an empty system</summary>
+		AnimationSystem();
+	public:
+		/// <summary>Adds an animation of a sprite node, the node is set to the first frame</summary>
+		/// <param name="data">The shared animation data, animations without data or frames aren't added</param>
+		/// <param name="node">The node to be animated</param>
+		/// <param name="play">True to start playing the animation, false otherwise</param>
+		/// <returns>The animation's id, NullAnimation if it wasn't added</returns>
+		/// <see cref="remove"/>
+		AnimationId add(std::shared_ptr<const Animation::Data> data, SpriteNode& node, bool play = true);
+		/// <summary>Removes an animation, its id may be reused</summary>
+		/// <param name="animation">The animation's id</param>
+		/// <see cref="add"/>
+		void remove(AnimationId animation);
+		/// <summary>Resumes an animation</summary>
+		/// <param name="animation">The animation's id</param>
+		/// <see cref="stop"/>
+		void play(AnimationId animation);
+		/// <summary>Pauses an animation</summary>
+		/// <param name="animation">The animation's id</param>
+		/// <see cref="play"/>
+		void stop(AnimationId animation);
+		/// <summary>Plays an animation from its first frame</summary>
+		/// <param name="animation">The animation's id</param>
+		void restart(AnimationId animation);
+		/// <summary>Jumps to a time of an animation, seeking past the end of a repeating animation wraps around</summary>
+		/// <param name="animation">The animation's id</param>
+		/// <param name="time">The time since the animation started</param>
+		void seek(AnimationId animation, sf::Time time);
+		/// <summary>Checks if an animation is playing, animations that don't repeat stop once over</summary>
+		/// <param name="animation">The animation's id</param>
+		/// <returns>True if it's playing, false otherwise</returns>
+		bool isPlaying(AnimationId animation) const;
+		/// <summary>Returns an animation's current frame</summary>
+		/// <param name="animation">The animation's id</param>
+		/// <returns>The frame's index</returns>
+		unsigned getFrame(AnimationId animation) const;
+		/// <summary>Returns the amount of animations</summary>
+		/// <returns>The amount of animations</returns>
+		inline size_t getAnimationCount() const { return states_.size() - free_animations_.size(); }
+		/// <summary>Returns the amount of sprite nodes whose frame changed during the last update</summary>
+		/// <returns>The amount of nodes updated</returns>
+		inline size_t getFrameChangeCount() const { return frame_changes_; }
+	private:
+		using DataPtr = std::shared_ptr<const Animation::Data>;
+
+		/// <summary>Playback state of an animation, the only data read by the stepping loop</summary>
+		struct State
+		{
+			const Animation::Data* data;    // Kept alive by data_ until the system is destroyed
+			sf::Time               time;    // Within the cycle
+			unsigned               frame;
+			bool                   playing;
+			bool                   alive;
+		};
+
+		/// <summary>Checks if an id references an animation</summary>
+		/// <param name="animation">The animation's id</param>
+		/// <returns>True if the animation exists, false otherwise</returns>
+		bool isValid(AnimationId animation) const;
+		/// <summary>Sets an animation's node to its current frame</summary>
+		/// <param name="animation">The animation's id</param>
+		void applyFrame(AnimationId animation);
+		/// <summary>Steps every playing animation and updates the nodes whose frame changed</summary>
+		/// <param name="dt">Time passed in current frame</param>
+		virtual void updateCurrent(sf::Time dt) override;
+
+	private:
+		std::vector<State>                                    states_;
+		std::vector<SceneNode::Handle>                        nodes_;            // Indexed like states_
+		std::vector<AnimationId>                              free_animations_;
+		std::unordered_map<const Animation::Data*, DataPtr>   data_;             // Every data added, once
+		std::vector<AnimationId>                              changed_;
+		size_t                                                frame_changes_;
+	};
+}
+#endif
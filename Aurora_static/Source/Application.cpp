@@ -1,6 +1,9 @@
 #include <SFML/Window/Event.hpp>
 
 #include "Application.h"
+#include "MaterialNode.h"
+#include "ParticleBudget.h"
+#include "Profiler.h"
 
 namespace au
 {
@@ -22,6 +25,7 @@ namespace au
 		sf::Time time_counter(sf::Time::Zero);
 		unsigned fps = 0;
 		while (window_.isOpen()) {
+			AU_PROFILE_BEGIN_FRAME();
 			processEvents();
 			sf::Time time_passed(clock.restart());
 
@@ -41,6 +45,7 @@ namespace au
 				update();
 			}
 			render();
+			AU_PROFILE_END_FRAME();
 		}
 	}
 
@@ -57,6 +62,8 @@ namespace au
 
 	void Application::processEvents()
 	{
+		AU_PROFILE_SCOPE("Application::processEvents", "application");
+
 		sf::Event event;
 		while (window_.pollEvent(event)) {
 			state_stack_.handleEvent(event);
@@ -69,13 +76,19 @@ namespace au
 
 	void Application::update()
 	{
+		AU_PROFILE_SCOPE("Application::update", "application");
 		state_stack_.update(time_per_frame_);
 	}
 
 	void Application::render()
 	{
+		AU_PROFILE_SCOPE("Application::render", "application");
+
 		window_.clear(clear_color_);
 		state_stack_.draw();
 		window_.display();
+
+		MaterialNode::resetWorldTransformRecomputations();
+		ParticleBudget::getDefault().endFrame();
 	}
 }
\ No newline at end of file
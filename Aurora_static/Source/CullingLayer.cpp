@@ -0,0 +1,142 @@
+#include <algorithm>
+
+#include "CullingLayer.h"
+#include "MaterialNode.h"
+#include "RenderQueue.h"
+
+namespace au
+{
+	CullingLayer::CullingLayer(float margin)
+		: spatial_index_(margin)
+		, dirty_children_()
+		, refreshed_children_()
+		, unculled_children_()
+		, visible_children_()
+		, dirty_mutex_()
+	{
+		setEventSubscriptions({});
+	}
+
+	CullingLayer::~CullingLayer()
+	{
+		for (const auto& child : children_) {
+			MaterialNode* material_child = dynamic_cast<MaterialNode*>(child.get());
+			if (material_child)
+				material_child->culling_layer_ = nullptr;
+		}
+	}
+
+	void CullingLayer::invalidateProxy(MaterialNode& child)
+	{
+		// Children may be transformed by concurrently updated subtrees
+		std::lock_guard<std::mutex> lock(dirty_mutex_);
+		if (!child.culling_proxy_dirty_) {
+			child.culling_proxy_dirty_ = true;
+			dirty_children_.push_back(&child);
+		}
+	}
+
+	void CullingLayer::refreshProxies() const
+	{
+		// Children transformed while their proxy is refreshed are marked dirty again
+		{
+			std::lock_guard<std::mutex> lock(dirty_mutex_);
+			refreshed_children_.swap(dirty_children_);
+			for (MaterialNode* child : refreshed_children_)
+				child->culling_proxy_dirty_ = false;
+		}
+
+		for (MaterialNode* child : refreshed_children_) {
+			const sf::FloatRect local_bounds(child->getLocalBounds());
+			const sf::FloatRect bounds(child->getTransform().transformRect(local_bounds));
+
+			if (local_bounds.width == 0.f && local_bounds.height == 0.f) {
+				if (child->culling_proxy_ != SpatialIndex::NullProxy) {
+					spatial_index_.destroyProxy(child->culling_proxy_);
+					child->culling_proxy_ = SpatialIndex::NullProxy;
+					unculled_children_.push_back(child);
+				}
+			}
+			else if (child->culling_proxy_ == SpatialIndex::NullProxy) {
+				unculled_children_.erase(std::find(unculled_children_.begin(), unculled_children_.end(), child));
+				child->culling_proxy_ = spatial_index_.createProxy(bounds, child);
+			}
+			else
+				spatial_index_.moveProxy(child->culling_proxy_, bounds);
+		}
+		refreshed_children_.clear();
+	}
+
+	void CullingLayer::collectVisibleChildren(const sf::View& view, const sf::Transform& transform) const
+	{
+		refreshProxies();
+
+		// The proxies are expressed in the layer's space
+		const sf::FloatRect view_rect(view.getInverseTransform().transformRect(sf::FloatRect(-1.f, -1.f, 2.f, 2.f)));
+		const sf::FloatRect local_view_rect(transform.getInverse().transformRect(view_rect));
+
+		visible_children_.assign(unculled_children_.begin(), unculled_children_.end());
+		spatial_index_.query(local_view_rect, [this](MaterialNode* child) {
+			visible_children_.push_back(child);
+		});
+
+		std::sort(visible_children_.begin(), visible_children_.end(), [](const SceneNode* lhs, const SceneNode* rhs) {
+			return lhs->index_in_parent_ < rhs->index_in_parent_;
+		});
+	}
+
+	void CullingLayer::onChildAttached(SceneNode& child)
+	{
+		MaterialNode* material_child = dynamic_cast<MaterialNode*>(&child);
+		unculled_children_.push_back(&child);
+
+		// The child's proxy is created once its bounds are known to be non-empty
+		if (material_child) {
+			material_child->culling_layer_ = this;
+			material_child->culling_proxy_ = SpatialIndex::NullProxy;
+			invalidateProxy(*material_child);
+		}
+	}
+
+	void CullingLayer::onChildDetached(SceneNode& child)
+	{
+		MaterialNode* material_child = dynamic_cast<MaterialNode*>(&child);
+		if (material_child && material_child->culling_proxy_ != SpatialIndex::NullProxy)
+			spatial_index_.destroyProxy(material_child->culling_proxy_);
+		else
+			unculled_children_.erase(std::find(unculled_children_.begin(), unculled_children_.end(), &child));
+
+		if (material_child) {
+			{
+				std::lock_guard<std::mutex> lock(dirty_mutex_);
+				if (material_child->culling_proxy_dirty_)
+					dirty_children_.erase(std::find(dirty_children_.begin(), dirty_children_.end(), material_child));
+				material_child->culling_proxy_dirty_ = false;
+			}
+
+			material_child->culling_layer_ = nullptr;
+			material_child->culling_proxy_ = SpatialIndex::NullProxy;
+		}
+	}
+
+	void CullingLayer::drawChildren(sf::RenderTarget& target, sf::RenderStates states) const
+	{
+		collectVisibleChildren(target.getView(), states.transform);
+
+		for (const SceneNode* child : visible_children_)
+			child->draw(target, states);
+	}
+
+	void CullingLayer::enqueueChildren(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		if (!queue.getView()) {
+			SceneNode::enqueueChildren(queue, states, layer);
+			return;
+		}
+
+		collectVisibleChildren(*queue.getView(), states.transform);
+
+		for (const SceneNode* child : visible_children_)
+			child->enqueueSubtree(queue, states, layer);
+	}
+}
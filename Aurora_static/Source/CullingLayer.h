@@ -0,0 +1,81 @@
+#ifndef Aurora_CullingLayer_H_
+#define Aurora_CullingLayer_H_
+
+#include <mutex>
+
+#include "SceneNode.h"
+#include "SpatialIndex.h"
+
+namespace au
+{
+	class MaterialNode;
+
+	/// <summary>
+	/// SceneNode derivative that only draws the children nodes situated inside the current view<para/>
+	/// The bounds of the material children are stored in a spatial index that's updated incrementally<para/>
+	/// when they're transformed, drawing then costs in proportion to the visible children only<para/>
+	/// A child's subtree is culled according to the child's own bounds, children with empty bounds<para/>
+	/// and non-material children are always drawn<para/>
+	/// Culling doesn't apply when the layer is part of a linear storage
+	/// </summary>
+	/// <example>
+	/// Typically used as a scene layer of a large scrolling level
+	/// <code>
+	/// auto layer(std::make_unique&lt;au::CullingLayer&gt;());
+	/// scene_layers_.push_back(layer.get());
+	/// scene_graph_.attachChild(std::move(layer));
+	/// </code>
+	/// </example>
+	class CullingLayer : public SceneNode
+	{
+		friend class MaterialNode;
+
+	public:
+		/// <summary>Constructs the culling layer</summary>
+		/// <param name="margin">The distance by which the children's bounds are fattened in the spatial index</param>
+		explicit CullingLayer(float margin = 16.f);
+		/// <summary>Virtual destructor</summary>
+		virtual ~CullingLayer();
+	public:
+		/// <summary>Returns the amount of children nodes drawn during the last draw</summary>
+		/// <returns>The amount of visible children nodes</returns>
+		inline size_t getVisibleChildCount() const { return visible_children_.size(); }
+		/// <summary>Returns the spatial index storing the children's bounds</summary>
+		/// <returns>The spatial index</returns>
+		inline const SpatialIndex& getSpatialIndex() const { return spatial_index_; }
+	private:
+		/// <summary>Marks the spatial index proxy of a child as outdated</summary>
+		/// <param name="child">The child node</param>
+		void invalidateProxy(MaterialNode& child);
+		/// <summary>Updates the outdated proxies of the spatial index</summary>
+		void refreshProxies() const;
+		/// <summary>Gathers the children nodes that intersect the view in children order</summary>
+		/// <param name="view">The view</param>
+		/// <param name="transform">The layer's transform</param>
+		void collectVisibleChildren(const sf::View& view, const sf::Transform& transform) const;
+		/// <summary>Registers a material child in the spatial index</summary>
+		/// <param name="child">The attached child node</param>
+		virtual void onChildAttached(SceneNode& child) override;
+		/// <summary>Unregisters a material child from the spatial index</summary>
+		/// <param name="child">The child node</param>
+		virtual void onChildDetached(SceneNode& child) override;
+		/// <summary>Draws the visible children nodes</summary>
+		/// <param name="target">Render target (window, render texture)</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		virtual void drawChildren(sf::RenderTarget& target, sf::RenderStates states) const override;
+		/// <summary>Collects the draw items of the visible children nodes, using the render queue's view</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The current node's render layer</param>
+		virtual void enqueueChildren(RenderQueue& queue, sf::RenderStates states, int layer) const override;
+
+	private:
+		mutable SpatialIndex               spatial_index_;
+		mutable std::vector<MaterialNode*> dirty_children_;
+		mutable std::vector<MaterialNode*> refreshed_children_;   // The dirty children being refreshed
+		mutable std::vector<SceneNode*>    unculled_children_;
+		mutable std::vector<SceneNode*>    visible_children_;
+		mutable std::mutex                 dirty_mutex_;          // Guards dirty_children_ and the children's dirty flags
+	};
+}
+#endif
@@ -0,0 +1,93 @@
+#include "EventRouter.h"
+#include "Profiler.h"
+
+namespace au
+{
+	EventRouter::EventRouter(SceneNode& root)
+		: root_(root)
+		, listeners_()
+		, stack_()
+		, pending_changes_(0)
+		, dispatching_(false)
+	{
+		rebuild();
+	}
+
+	void EventRouter::dispatch(const sf::Event& event)
+	{
+		synchronize();
+
+		if (event.type >= sf::Event::Count)
+			return;
+
+		const sf::Uint32 event_bit = 1u << event.type;
+		const std::vector<Listener>& listeners = listeners_[event.type];
+		dispatching_ = true;
+		for (size_t i = 0; i < listeners.size(); ++i) {
+			// Listeners may destroy, detach or deactivate the following ones, they're only checked once that happened
+			SceneNode* node = listeners[i].node;
+			if (isOutdated()) {
+				node = SceneNode::resolve(listeners[i].handle);
+				if (!node || !(node->event_subscriptions_ & event_bit) || !isReachable(*node))
+					continue;
+			}
+
+			AU_PROFILE_NODE_SCOPE(*node, "handleEventCurrent");
+			node->handleEventCurrent(event);
+		}
+		dispatching_ = false;
+	}
+
+	void EventRouter::synchronize()
+	{
+		if (!dispatching_ && isOutdated())
+			rebuild();
+	}
+
+	size_t EventRouter::getListenerCount(sf::Event::EventType type)
+	{
+		synchronize();
+
+		return listeners_[type].size();
+	}
+
+	void EventRouter::rebuild()
+	{
+		pending_changes_.store(0, std::memory_order_relaxed);
+		for (std::vector<Listener>& listeners : listeners_)
+			listeners.clear();
+
+		// Iterative depth-first traversal, children are pushed in reverse to preserve their order
+		stack_.assign(1, &root_);
+		while (!stack_.empty()) {
+			SceneNode* node = stack_.back();
+			stack_.pop_back();
+
+			if (node->activation_flags_ & SceneNode::EventHandlingCurrent) {
+				const Listener listener = { node, node->getHandle() };
+				for (sf::Uint32 subscriptions = node->event_subscriptions_; subscriptions; subscriptions &= subscriptions - 1) {
+					sf::Uint32 type = 0;
+					while (!(subscriptions & (1u << type)))
+						type++;
+					listeners_[type].push_back(listener);
+				}
+			}
+
+			if (node->activation_flags_ & SceneNode::EventHandlingChildren)
+				for (auto itr = node->children_.rbegin(); itr != node->children_.rend(); ++itr)
+					if (*itr)
+						stack_.push_back(itr->get());
+		}
+	}
+
+	bool EventRouter::isReachable(const SceneNode& node) const
+	{
+		if (!(node.activation_flags_ & SceneNode::EventHandlingCurrent))
+			return false;
+
+		for (const SceneNode* current = &node; current != &root_; current = current->parent_)
+			if (!current->parent_ || !(current->parent_->activation_flags_ & SceneNode::EventHandlingChildren))
+				return false;
+		return true;
+	}
+}
@@ -0,0 +1,72 @@
+#ifndef Aurora_EventRouter_H_
+#define Aurora_EventRouter_H_
+
+#include <array>
+#include <atomic>
+
+#include "SceneNode.h"
+
+namespace au
+{
+	/// <summary>
+	/// Routes the events of a SceneNode subtree to the nodes subscribed to their type<para/>
+	/// One listener list per event type is kept in depth-first order, an event is only sent to the<para/>
+	/// nodes of its type's list instead of being broadcast through the whole subtree, nodes only receive<para/>
+	/// the event types they subscribed to (see SceneNode::subscribeToEvent)<para/>
+	/// The lists are rebuilt whenever the structure, activation flags or subscriptions of the subtree change<para/>
+	/// Activated through SceneNode::activateEventRouting
+	/// </summary>
+	class EventRouter : private sf::NonCopyable
+	{
+	public:
+		using Handle = SceneNode::Handle;
+
+	public:
+		/// <summary>Constructs the event router of a root node's subtree</summary>
+		/// <param name="root">The root node</param>
+		explicit EventRouter(SceneNode& root);
+	public:
+		/// <summary>
+		/// Sends event to the subscribed nodes in depth-first order<para/>
+		/// Nodes attached while the event is dispatched only receive the following events
+		/// </summary>
+		/// <param name="event">Polled input event</param>
+		void dispatch(const sf::Event& event);
+		/// <summary>
+		/// Rebuilds the listener lists if the subtree's structure, activation flags or subscriptions changed<para/>
+		/// Deferred while an event is dispatched
+		/// </summary>
+		void synchronize();
+		/// <summary>Marks the listener lists as outdated, called by the nodes of the subtree</summary>
+		/// <param name="changes">The subtree changes (SceneNode::SubtreeChange flags)</param>
+		inline void invalidate(sf::Uint8 changes) { pending_changes_.fetch_or(changes, std::memory_order_relaxed); }
+		/// <summary>Returns the amount of nodes subscribed to an event type</summary>
+		/// <param name="type">The event type</param>
+		/// <returns>The amount of listeners</returns>
+		size_t getListenerCount(sf::Event::EventType type);
+	private:
+		struct Listener
+		{
+			SceneNode* node;
+			Handle     handle;
+		};
+
+		/// <summary>Collects the listeners of every event type in depth-first order</summary>
+		void rebuild();
+		/// <summary>Checks if the subtree was modified since the listener lists were built</summary>
+		/// <returns>True if the lists are outdated, false otherwise</returns>
+		inline bool isOutdated() const { return pending_changes_.load(std::memory_order_relaxed) != 0; }
+		/// <summary>Checks if a node would still receive an event broadcast from the root node</summary>
+		/// <param name="node">The node</param>
+		/// <returns>True if the node is reachable, false otherwise</returns>
+		bool isReachable(const SceneNode& node) const;
+
+	private:
+		SceneNode&                                                root_;
+		std::array<std::vector<Listener>, sf::Event::Count>       listeners_;
+		std::vector<SceneNode*>                                   stack_;
+		std::atomic<sf::Uint8>                                    pending_changes_;
+		bool                                                      dispatching_;
+	};
+}
+#endif
@@ -16,6 +16,7 @@ namespace au
 				attachChild(std::move(state));
 			}
 			activateCurrentState();
+			setEventSubscriptions({ sf::Event::MouseButtonPressed, sf::Event::MouseButtonReleased });
 		}
 
 		Button::Button(const sf::Vector2f& size, sf::RenderWindow* window)
@@ -29,6 +30,7 @@ namespace au
 				attachChild(std::move(state));
 			}
 			activateCurrentState();
+			setEventSubscriptions({ sf::Event::MouseButtonPressed, sf::Event::MouseButtonReleased });
 		}
 
 		Button::Button(const Button& copy)
@@ -139,5 +141,9 @@ namespace au
 			correctOriginFlagProperties();
 			alignText(OriginFlag::Center, 0.f);
 		}
+
+		void Button::enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const
+		{
+		}
 	}
 }
\ No newline at end of file
@@ -14,7 +14,9 @@ namespace au
 	{
 		/// <summary>
 		/// Class that provides gui button functionalities<para/>
-		/// The Button class contains the different states(idle, clicked, hovered over, etc.)
+		/// The Button class contains the different states(idle, clicked, hovered over, etc.)<para/>
+		/// Buttons are only subscribed to the mouse button events, derived classes handling<para/>
+		/// other events must subscribe to them
 		/// </summary>
 		class Button : public MaterialNode
 		{
@@ -71,6 +73,11 @@ namespace au
 			/// <summary>Updates the button</summary>
 			/// <param name="dt">Time passed for current frame</param>
 			virtual void updateCurrent(sf::Time dt) override;
+			/// <summary>The button's states and text are drawn as children, nothing is submitted</summary>
+			/// <param name="queue">The render queue</param>
+			/// <param name="states">Render states (transform, texture)</param>
+			/// <param name="layer">The node's render layer</param>
+			virtual void enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const override;
 		private:
 			/// <summary>Activates the current button state and deactivates the others</summary>
 			void activateCurrentState();
@@ -17,6 +17,8 @@ namespace au
 			attachChild(std::move(caret));
 
 			activateText(true);
+			subscribeToEvent(sf::Event::TextEntered, true);
+			subscribeToEvent(sf::Event::KeyPressed, true);
 		}
 
 		Textbox::Textbox(const sf::Vector2f& size, sf::RenderWindow* window)
@@ -32,6 +34,8 @@ namespace au
 			attachChild(std::move(caret));
 
 			activateText(true);
+			subscribeToEvent(sf::Event::TextEntered, true);
+			subscribeToEvent(sf::Event::KeyPressed, true);
 		}
 
 		Textbox::Textbox(const Textbox& copy)
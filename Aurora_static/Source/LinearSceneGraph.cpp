@@ -0,0 +1,229 @@
+#include "LinearSceneGraph.h"
+#include "MaterialNode.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
+
+namespace au
+{
+	const sf::Uint32 LinearSceneGraph::InvalidIndex;
+
+	LinearSceneGraph::LinearSceneGraph(SceneNode& root)
+		: root_(root)
+		, pending_changes_(0)
+		, traversing_(false)
+	{
+		rebuild();
+	}
+
+	void LinearSceneGraph::handleEvent(const sf::Event& event)
+	{
+		synchronize();
+
+		// The nodes' own flags are read, nodes may (de)activate the following ones
+		traversing_ = true;
+		for (sf::Uint32 i = 0; i < nodes_.size(); ) {
+			if ((pending_changes_.load(std::memory_order_relaxed) & SceneNode::StructureChange) && !isInPlace(i)) {
+				i = subtree_ends_[i];
+				continue;
+			}
+
+			SceneNode& node = *nodes_[i];
+			if (node.activation_flags_ & SceneNode::EventHandlingCurrent) {
+				AU_PROFILE_NODE_SCOPE(node, "handleEventCurrent");
+				node.handleEventCurrent(event);
+			}
+			i = (node.activation_flags_ & SceneNode::EventHandlingChildren) ? i + 1 : subtree_ends_[i];
+		}
+
+		traversing_ = false;
+		synchronize();
+	}
+
+	void LinearSceneGraph::update(sf::Time dt)
+	{
+		synchronize();
+
+		// Structural changes made by the nodes are only synchronized once every node was updated
+		traversing_ = true;
+		for (sf::Uint32 i = 0; i < nodes_.size(); ) {
+			if ((pending_changes_.load(std::memory_order_relaxed) & SceneNode::StructureChange) && !isInPlace(i)) {
+				i = subtree_ends_[i];
+				continue;
+			}
+
+			SceneNode& node = *nodes_[i];
+			node.removeChildrenMarkedForRemoval();
+			if (node.activation_flags_ & SceneNode::UpdatingCurrent) {
+				AU_PROFILE_NODE_SCOPE(node, "updateCurrent");
+				node.updateCurrent(dt);
+			}
+			i = (node.activation_flags_ & SceneNode::UpdatingChildren) ? i + 1 : subtree_ends_[i];
+		}
+
+		traversing_ = false;
+		synchronize();
+	}
+
+	void LinearSceneGraph::draw(sf::RenderTarget& target, sf::RenderStates states)
+	{
+		synchronize();
+
+		const sf::Transform root_transform(states.transform);
+		for (sf::Uint32 i = 0; i < nodes_.size(); ) {
+			// Parents always precede their children, their transform is already computed
+			transforms_[i] = parents_[i] == InvalidIndex ? root_transform : transforms_[parents_[i]];
+			if (material_nodes_[i])
+				transforms_[i] *= material_nodes_[i]->getTransform();
+
+			if (flags_[i] & SceneNode::DrawingCurrent) {
+				AU_PROFILE_NODE_SCOPE(*nodes_[i], "drawCurrent");
+				states.transform = transforms_[i];
+				nodes_[i]->drawCurrent(target, states);
+			}
+			i = (flags_[i] & SceneNode::DrawingChildren) ? i + 1 : subtree_ends_[i];
+		}
+
+		// Debugging bounding rects are drawn on top of the whole subtree
+		for (sf::Uint32 i = 0; i < nodes_.size(); ) {
+			if (material_nodes_[i] && material_nodes_[i]->drawing_global_bounding_rect_)
+				material_nodes_[i]->drawGlobalBoundingRect(target, states);
+			i = (flags_[i] & SceneNode::DrawingChildren) ? i + 1 : subtree_ends_[i];
+		}
+	}
+
+	void LinearSceneGraph::enqueue(RenderQueue& queue, sf::RenderStates states, int layer)
+	{
+		synchronize();
+
+		const sf::Transform root_transform(states.transform);
+		for (sf::Uint32 i = 0; i < nodes_.size(); ) {
+			const bool root = parents_[i] == InvalidIndex;
+			transforms_[i] = root ? root_transform : transforms_[parents_[i]];
+			if (material_nodes_[i])
+				transforms_[i] *= material_nodes_[i]->getTransform();
+
+			const int node_layer = nodes_[i]->render_layer_;
+			layers_[i] = node_layer != SceneNode::InheritedRenderLayer ? node_layer : (root ? layer : layers_[parents_[i]]);
+
+			if (flags_[i] & SceneNode::DrawingCurrent) {
+				states.transform = transforms_[i];
+				nodes_[i]->enqueueCurrent(queue, states, layers_[i]);
+			}
+			i = (flags_[i] & SceneNode::DrawingChildren) ? i + 1 : subtree_ends_[i];
+		}
+
+		for (sf::Uint32 i = 0; i < nodes_.size(); ) {
+			if (material_nodes_[i] && material_nodes_[i]->drawing_global_bounding_rect_)
+				material_nodes_[i]->enqueueGlobalBoundingRect(queue);
+			i = (flags_[i] & SceneNode::DrawingChildren) ? i + 1 : subtree_ends_[i];
+		}
+	}
+
+	void LinearSceneGraph::synchronize()
+	{
+		if (traversing_)
+			return;
+
+		const sf::Uint8 changes = pending_changes_.exchange(0, std::memory_order_relaxed);
+		if (changes & SceneNode::StructureChange)
+			rebuild();
+		else if (changes & SceneNode::ActivationChange)
+			refreshFlags();
+	}
+
+	LinearSceneGraph::Handle LinearSceneGraph::getHandle(const SceneNode& node)
+	{
+		synchronize();
+
+		const Handle handle = node.getHandle();
+		return findIndex(handle) != InvalidIndex ? handle : Handle();
+	}
+
+	SceneNode* LinearSceneGraph::getNode(Handle handle)
+	{
+		synchronize();
+
+		const sf::Uint32 index = findIndex(handle);
+		return index != InvalidIndex ? nodes_[index] : nullptr;
+	}
+
+	void LinearSceneGraph::rebuild()
+	{
+		nodes_.clear();
+		parents_.clear();
+
+		// Iterative depth-first traversal, children are pushed in reverse to preserve their order
+		std::vector<std::pair<SceneNode*, sf::Uint32>> stack(1, std::make_pair(&root_, InvalidIndex));
+		while (!stack.empty()) {
+			SceneNode* node = stack.back().first;
+			const sf::Uint32 parent = stack.back().second;
+			stack.pop_back();
+
+			const sf::Uint32 index = static_cast<sf::Uint32>(nodes_.size());
+			nodes_.push_back(node);
+			parents_.push_back(parent);
+
+			for (auto itr = node->children_.rbegin(); itr != node->children_.rend(); ++itr)
+				if (*itr)
+					stack.emplace_back(itr->get(), index);
+		}
+
+		const size_t node_count = nodes_.size();
+		subtree_ends_.resize(node_count);
+		for (sf::Uint32 i = 0; i < node_count; ++i)
+			subtree_ends_[i] = i + 1;
+		for (size_t i = node_count; i-- > 1; )
+			if (subtree_ends_[parents_[i]] < subtree_ends_[i])
+				subtree_ends_[parents_[i]] = subtree_ends_[i];
+
+		// The root's own transform is applied by its own draw method
+		material_nodes_.resize(node_count);
+		material_nodes_[0] = nullptr;
+		for (size_t i = 1; i < node_count; ++i)
+			material_nodes_[i] = dynamic_cast<const MaterialNode*>(nodes_[i]);
+		transforms_.resize(node_count);
+		layers_.resize(node_count);
+
+		// Outdated entries of the handle indices are detected by comparing the stored handles
+		handles_.resize(node_count);
+		for (sf::Uint32 i = 0; i < node_count; ++i) {
+			handles_[i] = nodes_[i]->getHandle();
+			if (handles_[i].index >= handle_indices_.size())
+				handle_indices_.resize(handles_[i].index + 1, InvalidIndex);
+			handle_indices_[handles_[i].index] = i;
+		}
+
+		refreshFlags();
+	}
+
+	void LinearSceneGraph::refreshFlags()
+	{
+		flags_.resize(nodes_.size());
+		for (size_t i = 0; i < nodes_.size(); ++i)
+			flags_[i] = nodes_[i]->activation_flags_;
+	}
+
+	bool LinearSceneGraph::isInPlace(sf::Uint32 index) const
+	{
+		// The parent was checked before its subtree was entered
+		return SceneNode::resolve(handles_[index]) == nodes_[index]
+		    && (parents_[index] == InvalidIndex || nodes_[index]->parent_ == nodes_[parents_[index]]);
+	}
+
+	sf::Uint32 LinearSceneGraph::findIndex(Handle handle) const
+	{
+		if (handle.index >= handle_indices_.size())
+			return InvalidIndex;
+
+		const sf::Uint32 index = handle_indices_[handle.index];
+		if (index >= handles_.size() || handles_[index] != handle)
+			return InvalidIndex;
+
+		// The arrays may be outdated while they're walked, the node and its ancestors are checked instead
+		if (pending_changes_.load(std::memory_order_relaxed) & SceneNode::StructureChange)
+			for (sf::Uint32 ancestor = index; ancestor != InvalidIndex; ancestor = parents_[ancestor])
+				if (!isInPlace(ancestor))
+					return InvalidIndex;
+		return index;
+	}
+}
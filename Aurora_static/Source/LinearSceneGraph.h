@@ -0,0 +1,109 @@
+#ifndef Aurora_LinearSceneGraph_H_
+#define Aurora_LinearSceneGraph_H_
+
+#include <atomic>
+
+#include <SFML/Graphics/RenderTarget.hpp>
+
+#include "SceneNode.h"
+
+namespace au
+{
+	class MaterialNode;
+
+	/// <summary>
+	/// Data-oriented storage of a SceneNode subtree<para/>
+	/// The hierarchy links, activation flags and transforms of every node are stored in contiguous<para/>
+	/// arrays sorted depth-first, event handling, updating and drawing then walk the arrays linearly<para/>
+	/// instead of recursing through every node's children<para/>
+	/// Nodes are referenced by their SceneNode handles, which are resolved in constant time<para/>
+	/// Only the changes made inside the subtree outdate the arrays, the changes made while the arrays are walked<para/>
+	/// are synchronized once the walk is over<para/>
+	/// Activated through SceneNode::activateLinearStorage
+	/// </summary>
+	class LinearSceneGraph : private sf::NonCopyable
+	{
+	public:
+		using Handle = SceneNode::Handle;
+		/// <summary>Value used for invalid indices</summary>
+		static const sf::Uint32 InvalidIndex = static_cast<sf::Uint32>(-1);
+
+	public:
+		/// <summary>Constructs the linear storage of a root node's subtree</summary>
+		/// <param name="root">The root node</param>
+		explicit LinearSceneGraph(SceneNode& root);
+	public:
+		/// <summary>
+		/// Sends event to all nodes in depth-first order<para/>
+		/// Nodes attached while the event is handled only receive the following events
+		/// </summary>
+		/// <param name="event">Polled input event</param>
+		void handleEvent(const sf::Event& event);
+		/// <summary>
+		/// Updates all nodes in depth-first order<para/>
+		/// Nodes attached during the update are first updated during the following update, nodes removed<para/>
+		/// or detached in the meantime are skipped along with their subtree
+		/// </summary>
+		/// <param name="dt">Time passed for current frame</param>
+		void update(sf::Time dt);
+		/// <summary>Draws all nodes in depth-first order</summary>
+		/// <param name="target">Render target (window, render texture)</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		void draw(sf::RenderTarget& target, sf::RenderStates states);
+		/// <summary>Collects the draw items of all nodes in depth-first order</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The root node's render layer</param>
+		void enqueue(RenderQueue& queue, sf::RenderStates states, int layer);
+		/// <summary>
+		/// Rebuilds the arrays if the subtree's structure or activation flags changed<para/>
+		/// Deferred while the arrays are walked
+		/// </summary>
+		void synchronize();
+		/// <summary>Marks the arrays as outdated, called by the nodes of the subtree</summary>
+		/// <param name="changes">The subtree changes (SceneNode::SubtreeChange flags)</param>
+		inline void invalidate(sf::Uint8 changes) { pending_changes_.fetch_or(changes, std::memory_order_relaxed); }
+		/// <summary>Returns the stable handle of a node inside the subtree</summary>
+		/// <param name="node">The node</param>
+		/// <returns>The node's handle, an invalid handle if the node isn't part of the subtree</returns>
+		/// <see cref="getNode"/>
+		Handle getHandle(const SceneNode& node);
+		/// <summary>Returns the node associated with a handle</summary>
+		/// <param name="handle">The node's handle</param>
+		/// <returns>The node, nullptr if it was destroyed or isn't part of the subtree anymore</returns>
+		/// <see cref="getHandle"/>
+		SceneNode* getNode(Handle handle);
+		/// <summary>Returns the amount of nodes stored</summary>
+		/// <returns>The amount of nodes</returns>
+		inline size_t getNodeCount() const { return nodes_.size(); }
+	private:
+		/// <summary>Flattens the subtree into depth-first sorted arrays</summary>
+		void rebuild();
+		/// <summary>Copies every node's activation flags into the flag array</summary>
+		void refreshFlags();
+		/// <summary>Checks if a node is still part of the subtree at the same place, its parent being part of it</summary>
+		/// <param name="index">The node's index</param>
+		/// <returns>True if the node wasn't destroyed, detached or moved, false otherwise</returns>
+		bool isInPlace(sf::Uint32 index) const;
+		/// <summary>Retrieves the index of a node</summary>
+		/// <param name="handle">The node's handle</param>
+		/// <returns>The node's index, InvalidIndex if the node isn't part of the subtree anymore</returns>
+		sf::Uint32 findIndex(Handle handle) const;
+
+	private:
+		SceneNode&                                      root_;
+		std::vector<SceneNode*>                         nodes_;
+		std::vector<sf::Uint32>                         parents_;
+		std::vector<sf::Uint32>                         subtree_ends_;
+		std::vector<sf::Uint8>                          flags_;
+		std::vector<const MaterialNode*>                material_nodes_;
+		std::vector<sf::Transform>                      transforms_;
+		std::vector<int>                                layers_;
+		std::vector<Handle>                             handles_;
+		std::vector<sf::Uint32>                         handle_indices_;
+
+		std::atomic<sf::Uint8>                          pending_changes_;
+		bool                                            traversing_;
+	};
+}
+#endif
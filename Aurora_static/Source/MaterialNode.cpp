@@ -1,17 +1,34 @@
+#include <typeinfo>
+
 #include "MaterialNode.h"
+#include "RenderQueue.h"
+#include "CullingLayer.h"
 
 namespace au
 {
+	std::atomic<unsigned> MaterialNode::frame_recomputations_(0);
+	unsigned MaterialNode::last_frame_recomputations_ = 0;
+
 	MaterialNode::MaterialNode()
 		: origin_flags_(OriginFlag::Left | OriginFlag::Top)
 		, drawing_global_bounding_rect_(false)
+		, world_transform_dirty_(true)
+		, culling_layer_(nullptr)
+		, culling_proxy_(SpatialIndex::NullProxy)
+		, culling_proxy_dirty_(false)
 	{
+		// Doesn't handle events, derived nodes handling some subscribe to them
+		setEventSubscriptions({});
 	}
 
 	MaterialNode::MaterialNode(const MaterialNode& copy)
 		: SceneNode(copy)
 		, origin_flags_(copy.origin_flags_)
 		, drawing_global_bounding_rect_(copy.drawing_global_bounding_rect_)
+		, world_transform_dirty_(true)
+		, culling_layer_(nullptr)
+		, culling_proxy_(SpatialIndex::NullProxy)
+		, culling_proxy_dirty_(false)
 	{
 		setOrigin(copy.getOrigin());
 		setPosition(copy.getPosition());
@@ -28,13 +45,87 @@ namespace au
 		return getWorldTransform() * sf::Vector2f();
 	}
 
-	sf::Transform MaterialNode::getWorldTransform() const
+	const sf::Transform& MaterialNode::getWorldTransform() const
+	{
+		if (world_transform_dirty_) {
+			const MaterialNode* material_parent = nullptr;
+			for (const SceneNode* node = parent_; node != nullptr && !material_parent; node = node->getParent())
+				material_parent = dynamic_cast<const MaterialNode*>(node);
+
+			world_transform_ = material_parent ? material_parent->getWorldTransform() * getTransform()
+			                                   : getTransform();
+			world_transform_dirty_ = false;
+			frame_recomputations_++;
+		}
+
+		return world_transform_;
+	}
+
+	void MaterialNode::setPosition(float x, float y)
+	{
+		sf::Transformable::setPosition(x, y);
+		invalidateWorldTransform();
+	}
+
+	void MaterialNode::setPosition(const sf::Vector2f& position)
+	{
+		setPosition(position.x, position.y);
+	}
+
+	void MaterialNode::setRotation(float angle)
+	{
+		sf::Transformable::setRotation(angle);
+		invalidateWorldTransform();
+	}
+
+	void MaterialNode::setScale(float factor_x, float factor_y)
+	{
+		sf::Transformable::setScale(factor_x, factor_y);
+		invalidateWorldTransform();
+	}
+
+	void MaterialNode::setScale(const sf::Vector2f& factors)
+	{
+		setScale(factors.x, factors.y);
+	}
+
+	void MaterialNode::setOrigin(float x, float y)
+	{
+		sf::Transformable::setOrigin(x, y);
+		invalidateWorldTransform();
+	}
+
+	void MaterialNode::setOrigin(const sf::Vector2f& origin)
+	{
+		setOrigin(origin.x, origin.y);
+	}
+
+	void MaterialNode::move(float offset_x, float offset_y)
 	{
-		sf::Transform transform;
-		for (const MaterialNode* node = this; node != nullptr; node = dynamic_cast<MaterialNode*>(parent_))
-			transform *= node->getTransform();
+		sf::Transformable::move(offset_x, offset_y);
+		invalidateWorldTransform();
+	}
 
-		return transform;
+	void MaterialNode::move(const sf::Vector2f& offset)
+	{
+		move(offset.x, offset.y);
+	}
+
+	void MaterialNode::rotate(float angle)
+	{
+		sf::Transformable::rotate(angle);
+		invalidateWorldTransform();
+	}
+
+	void MaterialNode::scale(float factor_x, float factor_y)
+	{
+		sf::Transformable::scale(factor_x, factor_y);
+		invalidateWorldTransform();
+	}
+
+	void MaterialNode::scale(const sf::Vector2f& factors)
+	{
+		scale(factors.x, factors.y);
 	}
 
 	void MaterialNode::setOriginFlags(sf::Uint16 origin_flags)
@@ -93,11 +184,53 @@ namespace au
 		return sf::FloatRect();
 	}
 
+	void MaterialNode::invalidateBounds()
+	{
+		if (culling_layer_)
+			culling_layer_->invalidateProxy(*this);
+	}
+
+	unsigned MaterialNode::getWorldTransformRecomputations()
+	{
+		return last_frame_recomputations_;
+	}
+
+	void MaterialNode::resetWorldTransformRecomputations()
+	{
+		last_frame_recomputations_ = frame_recomputations_;
+		frame_recomputations_ = 0;
+	}
+
 	void MaterialNode::correctOriginFlagProperties()
 	{
 		setOriginFlags(origin_flags_);
 	}
 
+	void MaterialNode::cacheWorldTransform() const
+	{
+		getWorldTransform();
+	}
+
+	void MaterialNode::enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		if (typeid(*this) != typeid(MaterialNode))
+			SceneNode::enqueueCurrent(queue, states, layer);
+	}
+
+	void MaterialNode::invalidateWorldTransform()
+	{
+		// Culling proxies are expressed in the culling layer's space, so only the node's own
+		// transformations affect them, those always reach this point even if the node is dirty
+		invalidateBounds();
+
+		// A dirty node's subtree is already dirty, as a world transform can
+		// only be recalculated once all of its parents' have been recalculated
+		if (!world_transform_dirty_) {
+			world_transform_dirty_ = true;
+			SceneNode::invalidateWorldTransform();
+		}
+	}
+
 	void MaterialNode::drawGlobalBoundingRect(sf::RenderTarget& target, sf::RenderStates states) const
 	{
 		const sf::FloatRect rect(getGlobalBounds());
@@ -111,6 +244,20 @@ namespace au
 		target.draw(shape);
 	}
 
+	void MaterialNode::enqueueGlobalBoundingRect(RenderQueue& queue) const
+	{
+		const sf::FloatRect rect(getGlobalBounds());
+		const sf::Vertex vertices[] = {
+			sf::Vertex(sf::Vector2f(rect.left,              rect.top),               sf::Color::Green),
+			sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top),               sf::Color::Green),
+			sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top + rect.height), sf::Color::Green),
+			sf::Vertex(sf::Vector2f(rect.left,              rect.top + rect.height), sf::Color::Green),
+			sf::Vertex(sf::Vector2f(rect.left,              rect.top),               sf::Color::Green)
+		};
+
+		queue.submit(vertices, 5, sf::LineStrip, sf::RenderStates::Default, std::numeric_limits<int>::max());
+	}
+
 	void MaterialNode::draw(sf::RenderTarget& target, sf::RenderStates states) const
 	{
 		states.transform *= getTransform();
@@ -119,4 +266,13 @@ namespace au
 		if (drawing_global_bounding_rect_)
 			drawGlobalBoundingRect(target, states);
 	}
+
+	void MaterialNode::enqueueSubtree(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		states.transform *= getTransform();
+		SceneNode::enqueueSubtree(queue, states, layer);
+
+		if (drawing_global_bounding_rect_)
+			enqueueGlobalBoundingRect(queue);
+	}
 }
\ No newline at end of file
@@ -9,8 +9,14 @@
 
 namespace au
 {
-	/// <summary>SceneNode derivative providing functionality for transformations</summary>
-	class MaterialNode : public SceneNode, public sf::Transformable
+	class CullingLayer;
+
+	/// <summary>
+	/// SceneNode derivative providing functionality for transformations<para/>
+	/// The sf::Transformable base isn't public so that every transformation goes through the node's setters,<para/>
+	/// which invalidate the cached world transforms, only its getters are exposed
+	/// </summary>
+	class MaterialNode : public SceneNode, protected sf::Transformable
 	{
 	public:
 		/// <summary>
@@ -32,6 +38,9 @@ namespace au
 			Top     = 1 << 4,
 			Bottom  = 1 << 5
 		};
+	private:
+		friend class LinearSceneGraph;
+		friend class CullingLayer;
 
 	public:
 		/// <summary>
@@ -45,17 +54,68 @@ namespace au
 		/// <summary>Virtual destructor</summary>
 		virtual ~MaterialNode();
 	public:
+		using sf::Transformable::getPosition;
+		using sf::Transformable::getRotation;
+		using sf::Transformable::getScale;
+		using sf::Transformable::getOrigin;
+		using sf::Transformable::getTransform;
+		using sf::Transformable::getInverseTransform;
+
 		/// <summary>Calculates and returns the world position of the node</summary>
 		/// <returns>The node's world position</returns>
 		/// <see cref="getWorldTransform"/>
 		sf::Vector2f getWorldPosition() const;
 		/// <summary>
-		/// Calculates and returns the world transform of the node by multiplying<para/>
-		/// every parent's transform until the root node is reached
+		/// Returns the world transform of the node (the closest material parent's world transform<para/>
+		/// multiplied by the node's own transform)<para/>
+		/// The world transform is cached and is only recalculated when the node or one of its<para/>
+		/// parents was transformed or reattached since the last call
 		/// </summary>
 		/// <returns>The node's world tranform</returns>
 		/// <see cref="getWorldPosition"/>
-		sf::Transform getWorldTransform() const;
+		/// <seealso cref="getWorldTransformRecomputations"/>
+		const sf::Transform& getWorldTransform() const;
+		/// <summary>Sets the position of the node and invalidates the world transform of the node's subtree</summary>
+		/// <param name="x">The position along the x axis</param>
+		/// <param name="y">The position along the y axis</param>
+		void setPosition(float x, float y);
+		/// <summary>Sets the position of the node and invalidates the world transform of the node's subtree</summary>
+		/// <param name="position">The new position</param>
+		void setPosition(const sf::Vector2f& position);
+		/// <summary>Sets the rotation of the node and invalidates the world transform of the node's subtree</summary>
+		/// <param name="angle">The new rotation in degrees</param>
+		void setRotation(float angle);
+		/// <summary>Sets the scale factors of the node and invalidates the world transform of the node's subtree</summary>
+		/// <param name="factor_x">The scale factor along the x axis</param>
+		/// <param name="factor_y">The scale factor along the y axis</param>
+		void setScale(float factor_x, float factor_y);
+		/// <summary>Sets the scale factors of the node and invalidates the world transform of the node's subtree</summary>
+		/// <param name="factors">The new scale factors</param>
+		void setScale(const sf::Vector2f& factors);
+		/// <summary>Sets the local origin of the node and invalidates the world transform of the node's subtree</summary>
+		/// <param name="x">The origin along the x axis</param>
+		/// <param name="y">The origin along the y axis</param>
+		void setOrigin(float x, float y);
+		/// <summary>Sets the local origin of the node and invalidates the world transform of the node's subtree</summary>
+		/// <param name="origin">The new origin</param>
+		void setOrigin(const sf::Vector2f& origin);
+		/// <summary>Moves the node by an offset and invalidates the world transform of the node's subtree</summary>
+		/// <param name="offset_x">The offset along the x axis</param>
+		/// <param name="offset_y">The offset along the y axis</param>
+		void move(float offset_x, float offset_y);
+		/// <summary>Moves the node by an offset and invalidates the world transform of the node's subtree</summary>
+		/// <param name="offset">The offset</param>
+		void move(const sf::Vector2f& offset);
+		/// <summary>Rotates the node by an angle and invalidates the world transform of the node's subtree</summary>
+		/// <param name="angle">The angle in degrees</param>
+		void rotate(float angle);
+		/// <summary>Scales the node by factors and invalidates the world transform of the node's subtree</summary>
+		/// <param name="factor_x">The scale factor along the x axis</param>
+		/// <param name="factor_y">The scale factor along the y axis</param>
+		void scale(float factor_x, float factor_y);
+		/// <summary>Scales the node by factors and invalidates the world transform of the node's subtree</summary>
+		/// <param name="factors">The scale factors</param>
+		void scale(const sf::Vector2f& factors);
 		/// <summary>
 		/// Origin flags are an automatic way to set the local origin of a material node<para/>
 		/// All of the origin flags except the Center origin flag can be paired together
@@ -90,6 +150,12 @@ namespace au
 		/// <returns>The node's local bounds</returns>
 		/// <see cref="getGlobalBounds"/>
 		virtual sf::FloatRect getLocalBounds() const;
+		/// <summary>
+		/// Informs the culling layer containing the node that its local bounds changed<para/>
+		/// Must be called by derived classes whose local bounds change without the node being transformed
+		/// </summary>
+		/// <see cref="CullingLayer"/>
+		void invalidateBounds();
 		/// <summary>Returns the origin flags</summary>
 		/// <returns>The node's origin flags</returns>
 		/// <see cref="setOriginFlags"/>
@@ -101,10 +167,30 @@ namespace au
 		/// <param name="flag">True to activate, false otherwise</param>
 		/// <see cref="drawGlobalBoundingRect"/>
 		inline void activateGlobalBoundingRect(bool flag) { drawing_global_bounding_rect_ = flag; }
+		/// <summary>Returns the amount of world transforms that were recalculated during the last frame</summary>
+		/// <returns>The amount of world transform recalculations</returns>
+		/// <see cref="getWorldTransform"/>
+		/// <seealso cref="resetWorldTransformRecomputations"/>
+		static unsigned getWorldTransformRecomputations();
+		/// <summary>
+		/// Closes the current frame's world transform recalculation count<para/>
+		/// Called by the Application once per frame
+		/// </summary>
+		/// <see cref="getWorldTransformRecomputations"/>
+		static void resetWorldTransformRecomputations();
 	protected:
 		/// <summary>Recalculates the origin position based on the origin flags</summary>
 		/// <see cref="setOriginFlags"/>
 		void correctOriginFlagProperties();
+		/// <summary>Marks the cached world transform of the node and its subtree as outdated</summary>
+		virtual void invalidateWorldTransform() override;
+		/// <summary>Recalculates the node's world transform if it's outdated</summary>
+		virtual void cacheWorldTransform() const override;
+		/// <summary>Submits the node's draw items, plain material nodes don't submit any</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The node's render layer</param>
+		virtual void enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const override;
 	private:
 		/// <summary>Draws the global bounding rect of the node for debugging purposes</summary>
 		/// <param name="target">Render target (window, render texture)</param>
@@ -112,14 +198,31 @@ namespace au
 		/// <see cref="activateGlobalBoundingRect"/>
 		/// <seealso cref="getGlobalBounds"/>
 		void drawGlobalBoundingRect(sf::RenderTarget& target, sf::RenderStates states) const;
+		/// <summary>Submits the global bounding rect of the node on top of all render layers</summary>
+		/// <param name="queue">The render queue</param>
+		/// <see cref="activateGlobalBoundingRect"/>
+		void enqueueGlobalBoundingRect(RenderQueue& queue) const;
 		/// <summary>Multiplies the states transform by its own transform and then draws all nodes</summary>
 		/// <param name="target">Render target (window, render texture)</param>
 		/// <param name="states">Render states (transform, texture)</param>
 		virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override final;
+		/// <summary>Multiplies the states transform by its own transform and then enqueues all nodes</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The parent's render layer</param>
+		virtual void enqueueSubtree(RenderQueue& queue, sf::RenderStates states, int layer) const override final;
 
 	private:
-		sf::Uint16 origin_flags_;
-		bool       drawing_global_bounding_rect_;
+		sf::Uint16                   origin_flags_;
+		bool                         drawing_global_bounding_rect_;
+		mutable sf::Transform        world_transform_;
+		mutable bool                 world_transform_dirty_;
+		CullingLayer*                culling_layer_;
+		sf::Int32                    culling_proxy_;
+		bool                         culling_proxy_dirty_;
+
+		static std::atomic<unsigned> frame_recomputations_;
+		static unsigned              last_frame_recomputations_;
 	};
 }
 #endif
\ No newline at end of file
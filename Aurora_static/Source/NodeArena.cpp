@@ -0,0 +1,190 @@
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#include "NodeArena.h"
+
+namespace au
+{
+	namespace
+	{
+		const size_t MaxPendingNodes = 32;
+
+		/// <summary>
+		/// Nodes allocated from an arena on a thread whose constructor didn't claim them yet<para/>
+		/// Only nested when a node's other base classes create nodes before its SceneNode base
+		/// </summary>
+		struct ConstructedNodes
+		{
+			const char* begin[MaxPendingNodes];
+			const char* end[MaxPendingNodes];
+			size_t      count;
+		};
+
+		/// <summary>
+		/// Nodes allocated from an arena destroyed on a thread whose memory isn't deallocated yet<para/>
+		/// Only nested when a node's other base classes destroy nodes after its SceneNode base
+		/// </summary>
+		struct DestroyedNodes
+		{
+			const char* node[MaxPendingNodes];
+			size_t      count;
+		};
+
+		// Trivially destructible, nodes with static storage may be destroyed after the thread's variables
+		thread_local ConstructedNodes constructed_nodes = {};
+		thread_local DestroyedNodes   destroyed_nodes = {};
+	}
+
+	const size_t NodeArena::HeaderSize;
+	const size_t NodeArena::Granularity;
+	const size_t NodeArena::SizeClassCount;
+	thread_local NodeArena* NodeArena::current_ = nullptr;
+
+	NodeArena::NodeArena(size_t chunk_size)
+		: storage_(new Storage(chunk_size))
+	{
+		static_assert(sizeof(Header) <= HeaderSize, "The header must fit in front of the node");
+		assert(chunk_size >= SizeClassCount * Granularity);
+	}
+
+	NodeArena::~NodeArena()
+	{
+		// Nodes outliving the arena keep its chunks alive, the last one deletes them
+		if (storage_->release())
+			delete storage_;
+	}
+
+	void* NodeArena::allocate(size_t size)
+	{
+		NodeArena* arena = current_;
+		const size_t size_class = (size + HeaderSize - 1) / Granularity;
+		if (!arena || size_class >= SizeClassCount || constructed_nodes.count == MaxPendingNodes)
+			return ::operator new(size);
+
+		Header* header = static_cast<Header*>(arena->storage_->allocateBlock(size_class));
+		header->storage = arena->storage_;
+		header->size_class = size_class;
+
+		char* memory = reinterpret_cast<char*>(header) + HeaderSize;
+		constructed_nodes.begin[constructed_nodes.count] = memory;
+		constructed_nodes.end[constructed_nodes.count] = memory + size;
+		constructed_nodes.count++;
+		return memory;
+	}
+
+	void NodeArena::deallocate(void* memory, size_t size)
+	{
+		if (!memory)
+			return;
+
+		// Released by the node's destructor, or never claimed if the node's construction failed
+		const char* begin = static_cast<const char*>(memory);
+		bool from_arena = false;
+		if (destroyed_nodes.count > 0) {
+			const char* node = destroyed_nodes.node[destroyed_nodes.count - 1];
+			if (node >= begin && node < begin + size) {
+				destroyed_nodes.count--;
+				from_arena = true;
+			}
+		}
+		if (!from_arena && constructed_nodes.count > 0 && constructed_nodes.begin[constructed_nodes.count - 1] == begin) {
+			constructed_nodes.count--;
+			from_arena = true;
+		}
+
+		if (!from_arena) {
+			::operator delete(memory);
+			return;
+		}
+
+		Header* header = reinterpret_cast<Header*>(static_cast<char*>(memory) - HeaderSize);
+		Storage* storage = header->storage;
+		if (storage->deallocateBlock(header, header->size_class))
+			delete storage;
+	}
+
+	bool NodeArena::claim(const void* node)
+	{
+		const char* address = static_cast<const char*>(node);
+		if (constructed_nodes.count == 0)
+			return false;
+
+		const size_t last = constructed_nodes.count - 1;
+		if (address < constructed_nodes.begin[last] || address >= constructed_nodes.end[last])
+			return false;
+
+		constructed_nodes.count--;
+		return true;
+	}
+
+	void NodeArena::release(const void* node)
+	{
+		// The memory would be returned to the global heap otherwise
+		if (destroyed_nodes.count == MaxPendingNodes)
+			std::abort();
+
+		destroyed_nodes.node[destroyed_nodes.count++] = static_cast<const char*>(node);
+	}
+
+	NodeArena::Scope::Scope(NodeArena* arena)
+		: previous_(current_)
+	{
+		current_ = arena;
+	}
+
+	NodeArena::Scope::~Scope()
+	{
+		current_ = previous_;
+	}
+
+	NodeArena::Storage::Storage(size_t chunk_size)
+		: chunk_size(chunk_size)
+		, chunks()
+		, chunk_offset(chunk_size)
+		, free_lists(SizeClassCount, nullptr)
+		, node_count(0)
+		, released(false)
+		, mutex()
+	{
+	}
+
+	void* NodeArena::Storage::allocateBlock(size_t size_class)
+	{
+		// Nodes may be created and destroyed by concurrently updated subtrees
+		std::lock_guard<std::mutex> lock(mutex);
+		node_count++;
+
+		void* block = free_lists[size_class];
+		if (block) {
+			free_lists[size_class] = *static_cast<void**>(block);
+			return block;
+		}
+
+		const size_t block_size = (size_class + 1) * Granularity;
+		if (chunk_offset + block_size > chunk_size) {
+			chunks.emplace_back(new char[chunk_size]);
+			chunk_offset = 0;
+		}
+		block = chunks.back().get() + chunk_offset;
+		chunk_offset += block_size;
+		return block;
+	}
+
+	bool NodeArena::Storage::deallocateBlock(void* block, size_t size_class)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		node_count--;
+
+		*static_cast<void**>(block) = free_lists[size_class];
+		free_lists[size_class] = block;
+		return released && node_count == 0;
+	}
+
+	bool NodeArena::Storage::release()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		released = true;
+		return node_count == 0;
+	}
+}
@@ -0,0 +1,128 @@
+#ifndef Aurora_NodeArena_H_
+#define Aurora_NodeArena_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <SFML/System/NonCopyable.hpp>
+
+namespace au
+{
+	/// <summary>
+	/// Memory arena from which scene nodes are allocated instead of the global heap<para/>
+	/// Nodes are allocated from large chunks split into size classes, freed nodes are kept in<para/>
+	/// per size class free lists and reused by the following nodes of a similar size<para/>
+	/// The chunks are returned in bulk once the arena and all of its nodes are destroyed, nodes may outlive the arena<para/>
+	/// Nodes created by an arena, including the nodes created by their constructors, are deleted<para/>
+	/// through the usual std::unique_ptr ownership and can be attached like any other node<para/>
+	/// Only the nodes allocated from an arena carry the header locating their arena, heap nodes don't
+	/// </summary>
+	/// <see cref="State::createNode"/>
+	class NodeArena : private sf::NonCopyable
+	{
+	public:
+		/// <summary>Constructs the arena</summary>
+		/// <param name="chunk_size">The size in bytes of the chunks reserved by the arena</param>
+		explicit NodeArena(size_t chunk_size = 64 * 1024);
+		/// <summary>Releases the chunks reserved by the arena, or lets the last of its nodes release them</summary>
+		~NodeArena();
+	public:
+		/// <summary>Creates a node allocated from the arena</summary>
+		/// <param name="args">The arguments passed to the node's constructor</param>
+		/// <returns>The created node</returns>
+		template <typename T, typename... Args>
+		std::unique_ptr<T> create(Args&&... args);
+		/// <summary>Returns the amount of nodes currently allocated from the arena</summary>
+		/// <returns>The amount of nodes</returns>
+		inline size_t getNodeCount() const { return storage_->node_count; }
+		/// <summary>Returns the amount of memory reserved by the arena</summary>
+		/// <returns>The reserved memory in bytes</returns>
+		inline size_t getReservedSize() const { return storage_->chunks.size() * storage_->chunk_size; }
+		/// <summary>
+		/// Allocates the memory of a node from the arena creating it on the current thread<para/>
+		/// The global heap is used if no arena is creating a node or if the node is too large<para/>
+		/// Used by SceneNode::operator new
+		/// </summary>
+		/// <param name="size">The node's size</param>
+		/// <returns>The node's memory</returns>
+		static void* allocate(size_t size);
+		/// <summary>
+		/// Returns the memory of a node to the arena it was allocated from or to the global heap<para/>
+		/// Used by SceneNode::operator delete
+		/// </summary>
+		/// <param name="memory">The node's memory</param>
+		/// <param name="size">The node's size</param>
+		/// <see cref="allocate"/>
+		static void deallocate(void* memory, size_t size);
+		/// <summary>
+		/// Checks if a node being constructed on the current thread was allocated from an arena<para/>
+		/// Called once by the SceneNode constructors
+		/// </summary>
+		/// <param name="node">The node being constructed</param>
+		/// <returns>True if the node was allocated from an arena</returns>
+		static bool claim(const void* node);
+		/// <summary>
+		/// Tells deallocate that a node allocated from an arena is being destroyed on the current thread<para/>
+		/// Called by the SceneNode destructor after the node's children are destroyed
+		/// </summary>
+		/// <param name="node">The node being destroyed</param>
+		/// <see cref="claim"/>
+		static void release(const void* node);
+	private:
+		/// <summary>
+		/// Chunks of an arena, shared by the arena and its nodes<para/>
+		/// Deleted by the arena or by the last of its nodes, whichever is destroyed last
+		/// </summary>
+		struct Storage
+		{
+			explicit Storage(size_t chunk_size);
+
+			/// <summary>Retrieves a block from the size class' free list or from the current chunk</summary>
+			/// <param name="size_class">The block's size class</param>
+			/// <returns>The block</returns>
+			void* allocateBlock(size_t size_class);
+			/// <summary>Pushes a block onto its size class' free list</summary>
+			/// <param name="block">The block</param>
+			/// <param name="size_class">The block's size class</param>
+			/// <returns>True if the storage was released by its arena and the block was its last node</returns>
+			bool deallocateBlock(void* block, size_t size_class);
+			/// <summary>Called once the arena is destroyed</summary>
+			/// <returns>True if the storage has no node left</returns>
+			bool release();
+
+			size_t                               chunk_size;
+			std::vector<std::unique_ptr<char[]>> chunks;
+			size_t                               chunk_offset;
+			std::vector<void*>                   free_lists;
+			size_t                               node_count;
+			bool                                 released;
+			std::mutex                           mutex;
+		};
+		/// <summary>Memory placed in front of the nodes allocated from an arena that stores where they were allocated from</summary>
+		struct Header
+		{
+			Storage* storage;
+			size_t   size_class;
+		};
+		/// <summary>Makes an arena allocate the nodes created on the current thread until it's destroyed</summary>
+		class Scope
+		{
+		public:
+			explicit Scope(NodeArena* arena);
+			~Scope();
+		private:
+			NodeArena* previous_;
+		};
+
+	private:
+		static const size_t                  HeaderSize = 16;
+		static const size_t                  Granularity = 16;
+		static const size_t                  SizeClassCount = 64;
+		static thread_local NodeArena*       current_;
+
+		Storage*                             storage_;
+	};
+}
+#include "NodeArena.inl"
+#endif
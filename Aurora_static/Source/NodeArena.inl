@@ -0,0 +1,9 @@
+namespace au
+{
+	template <typename T, typename... Args>
+	std::unique_ptr<T> NodeArena::create(Args&&... args)
+	{
+		Scope scope(this);
+		return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
+	}
+}
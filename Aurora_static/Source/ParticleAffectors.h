@@ -0,0 +1,77 @@
+#ifndef Aurora_ParticleAffectors_H_
+#define Aurora_ParticleAffectors_H_
+
+#include <algorithm>
+
+#include "ParticleStorage.h"
+
+namespace au
+{
+	/// <summary>
+	/// Built-in affectors of the ParticleSystemT class<para/>
+	/// An affector is a function object called with a span, the index of a particle and the frame time in seconds,<para/>
+	/// they're inlined and fused into a single loop over the particles
+	/// </summary>
+	namespace affectors
+	{
+		/// <summary>Accelerates the particles in a constant direction</summary>
+		struct Gravity
+		{
+			explicit Gravity(sf::Vector2f acceleration = sf::Vector2f(0.f, 98.f)) : acceleration(acceleration) {}
+
+			inline void operator()(const ParticleSpan& span, size_t i, float dt) const
+			{
+				span.velocity_x[i] += acceleration.x * dt;
+				span.velocity_y[i] += acceleration.y * dt;
+			}
+
+			sf::Vector2f acceleration;
+		};
+
+		/// <summary>Slows the particles down proportionally to their velocity</summary>
+		struct Drag
+		{
+			explicit Drag(float coefficient = 1.f) : coefficient(coefficient) {}
+
+			inline void operator()(const ParticleSpan& span, size_t i, float dt) const
+			{
+				const float factor = std::max(1.f - coefficient * dt, 0.f);
+				span.velocity_x[i] *= factor;
+				span.velocity_y[i] *= factor;
+			}
+
+			float coefficient;
+		};
+
+		/// <summary>Applies the particles' acceleration to their velocity and their velocity to their position</summary>
+		struct Integration
+		{
+			inline void operator()(const ParticleSpan& span, size_t i, float dt) const
+			{
+				span.velocity_x[i] += span.acceleration_x[i] * dt;
+				span.velocity_y[i] += span.acceleration_y[i] * dt;
+				span.position_x[i] += span.velocity_x[i] * dt;
+				span.position_y[i] += span.velocity_y[i] * dt;
+			}
+		};
+
+		/// <summary>Interpolates the particles' color from a start color at spawn to an end color at expiry</summary>
+		struct ColorOverLife
+		{
+			ColorOverLife(sf::Color start = sf::Color::White, sf::Color end = sf::Color::Transparent) : start(start), end(end) {}
+
+			inline void operator()(const ParticleSpan& span, size_t i, float) const
+			{
+				const float t = 1.f - std::min(std::max(span.lifetime[i] * span.inverse_lifetime[i], 0.f), 1.f);
+				const auto lerp = [t](sf::Uint8 from, sf::Uint8 to) {
+					return static_cast<sf::Uint8>(from + (static_cast<float>(to) - from) * t);
+				};
+				span.color[i] = sf::Color(lerp(start.r, end.r), lerp(start.g, end.g), lerp(start.b, end.b), lerp(start.a, end.a));
+			}
+
+			sf::Color start;
+			sf::Color end;
+		};
+	}
+}
+#endif
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ParticleBudget.h"
+
+namespace au
+{
+	namespace
+	{
+		// The level never drops to zero so that the systems' emission resumes gradually
+		const float MinLevel = 0.05f;
+		// Recovery only starts once there's headroom, the level would oscillate otherwise
+		const float RecoveryThreshold = 0.9f;
+		const float RecoveryStep = 0.02f;
+	}
+
+	ParticleBudget::ParticleBudget()
+		: frame_budget_(sf::Time::Zero)
+		, level_(1.f)
+		, cost_(0)
+		, shed_particles_(0)
+		, capped_particles_(0)
+		, culled_systems_(0)
+		, last_frame_stats_()
+		, simulations_()
+		, simulations_mutex_()
+	{
+	}
+
+	void ParticleBudget::setFrameBudget(sf::Time budget)
+	{
+		frame_budget_ = std::max(budget, sf::Time::Zero);
+		if (!isActive())
+			level_ = 1.f;
+	}
+
+	float ParticleBudget::getScale(Priority priority) const
+	{
+		switch (priority) {
+		case Priority::Low:
+			return level_ * level_;
+		case Priority::Normal:
+			return level_;
+		case Priority::High:
+			return std::sqrt(level_);
+		default:
+			return 1.f;
+		}
+	}
+
+	size_t ParticleBudget::scaleMaxParticles(size_t max_particles, size_t full_detail_particles, float scale)
+	{
+		if (scale >= 1.f)
+			return max_particles;
+
+		// At least one particle remains allowed
+		const size_t max = max_particles != 0 ? max_particles : full_detail_particles;
+		return max != 0 ? std::max(static_cast<size_t>(max * scale), size_t(1)) : 0;
+	}
+
+	void ParticleBudget::reportCost(sf::Time cost)
+	{
+		cost_.fetch_add(cost.asMicroseconds(), std::memory_order_relaxed);
+	}
+
+	void ParticleBudget::reportShedding(size_t shed_particles, size_t capped_particles, bool culled)
+	{
+		shed_particles_.fetch_add(shed_particles, std::memory_order_relaxed);
+		capped_particles_.fetch_add(capped_particles, std::memory_order_relaxed);
+		if (culled)
+			culled_systems_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void ParticleBudget::addSimulation(TaskPool::Group& simulation)
+	{
+		std::lock_guard<std::mutex> lock(simulations_mutex_);
+		simulations_.push_back(&simulation);
+	}
+
+	void ParticleBudget::removeSimulation(TaskPool::Group& simulation)
+	{
+		std::lock_guard<std::mutex> lock(simulations_mutex_);
+		simulations_.erase(std::remove(simulations_.begin(), simulations_.end(), &simulation), simulations_.end());
+	}
+
+	void ParticleBudget::endFrame()
+	{
+		// Simulations reporting their cost after the frame closed would be booked to the next frame
+		{
+			std::lock_guard<std::mutex> lock(simulations_mutex_);
+			for (TaskPool::Group* simulation : simulations_)
+				TaskPool::getDefault().wait(*simulation);
+			simulations_.clear();
+		}
+
+		last_frame_stats_.cost = sf::microseconds(cost_.exchange(0, std::memory_order_relaxed));
+		last_frame_stats_.level = level_;
+		last_frame_stats_.shed_particles = shed_particles_.exchange(0, std::memory_order_relaxed);
+		last_frame_stats_.capped_particles = capped_particles_.exchange(0, std::memory_order_relaxed);
+		last_frame_stats_.culled_systems = culled_systems_.exchange(0, std::memory_order_relaxed);
+
+		if (!isActive())
+			return;
+
+		// The cost is assumed proportional to the level, the level is lowered at once to fit the budget
+		const float cost = last_frame_stats_.cost.asSeconds();
+		const float budget = frame_budget_.asSeconds();
+		if (cost > budget)
+			level_ = std::max(level_ * budget / cost, MinLevel);
+		else if (cost < budget * RecoveryThreshold)
+			level_ = std::min(level_ + RecoveryStep, 1.f);
+	}
+
+	ParticleBudget& ParticleBudget::getDefault()
+	{
+		static ParticleBudget budget;
+		return budget;
+	}
+}
@@ -0,0 +1,121 @@
+#ifndef Aurora_ParticleBudget_H_
+#define Aurora_ParticleBudget_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include "TaskPool.h"
+
+namespace au
+{
+	/// <summary>
+	/// Frame budget shared by the particle systems, degrading their level of detail under pressure<para/>
+	/// Particle systems report the cost of their updates, once a frame cost more than the budget the detail<para/>
+	/// level is lowered proportionally and it's then raised back gradually while the cost stays below the budget<para/>
+	/// Below full detail, particle systems and particle managers scale their emission and max particles by the level<para/>
+	/// according to their priority, particle systems also skip the emission, affectors and vertices of their particles<para/>
+	/// while off-screen. Unlimited particle systems are limited relative to their particle count at full detail<para/>
+	/// The budget is inactive until a frame budget is set
+	/// </summary>
+	class ParticleBudget : private sf::NonCopyable
+	{
+	public:
+		/// <summary>How much of a particle system's detail is shed under pressure, critical systems are never degraded</summary>
+		enum class Priority { Low, Normal, High, Critical };
+
+		/// <summary>What was shed during a frame</summary>
+		struct Stats
+		{
+			sf::Time cost;                   // Update cost reported by the particle systems
+			float    level            = 1.f; // Detail level the frame was updated with
+			size_t   shed_particles   = 0;   // Particles left unemitted because of the scaled emission rates
+			size_t   capped_particles = 0;   // Particles left unemitted because of the scaled max particles
+			size_t   culled_systems   = 0;   // Off-screen particle systems whose update was reduced
+		};
+
+	public:
+		/// <summary>Constructs an inactive budget</summary>
+		ParticleBudget();
+	public:
+		/// <summary>Sets the update cost allowed to the particle systems per frame</summary>
+		/// <param name="budget">The frame budget, sf::Time::Zero to deactivate the budget</param>
+		/// <see cref="getFrameBudget"/>
+		void setFrameBudget(sf::Time budget);
+		/// <summary>Returns the update cost allowed to the particle systems per frame</summary>
+		/// <returns>The frame budget, sf::Time::Zero if the budget is inactive</returns>
+		/// <see cref="setFrameBudget"/>
+		inline sf::Time getFrameBudget() const { return frame_budget_; }
+		/// <summary>Checks if a frame budget was set</summary>
+		/// <returns>True if the budget is active, false otherwise</returns>
+		inline bool isActive() const { return frame_budget_ != sf::Time::Zero; }
+		/// <summary>Returns the current detail level</summary>
+		/// <returns>The level, 1 for full detail</returns>
+		inline float getLevel() const { return level_; }
+		/// <summary>
+		/// Returns the factor applied to the emission rate and max particles of a priority at the current level<para/>
+		/// Low priorities are scaled by the level squared, normal by the level, high by its square root
+		/// </summary>
+		/// <param name="priority">The particle system's priority</param>
+		/// <returns>The factor, 1 for full detail</returns>
+		float getScale(Priority priority) const;
+		/// <summary>Returns the max particles of a particle system at a scale</summary>
+		/// <param name="max_particles">The system's max particles, 0 for no limit</param>
+		/// <param name="full_detail_particles">The system's particle count when it was last updated at full detail</param>
+		/// <param name="scale">The system's scale</param>
+		/// <returns>The scaled max particles, at least one, 0 for no limit</returns>
+		/// <see cref="getScale"/>
+		static size_t scaleMaxParticles(size_t max_particles, size_t full_detail_particles, float scale);
+		/// <summary>Checks if off-screen particle systems of a priority are culled at the current level</summary>
+		/// <param name="priority">The particle system's priority</param>
+		/// <returns>True if they're culled, false otherwise</returns>
+		inline bool isCulling(Priority priority) const { return level_ < 1.f && priority != Priority::Critical; }
+		/// <summary>Adds to the current frame's update cost, may be called concurrently</summary>
+		/// <param name="cost">The time a particle system spent updating</param>
+		void reportCost(sf::Time cost);
+		/// <summary>Adds to the current frame's shed counters, may be called concurrently</summary>
+		/// <param name="shed_particles">Particles left unemitted because of a scaled emission rate</param>
+		/// <param name="capped_particles">Particles left unemitted because of a scaled max particles</param>
+		/// <param name="culled">True if the particle system was culled, false otherwise</param>
+		void reportShedding(size_t shed_particles, size_t capped_particles, bool culled);
+		/// <summary>
+		/// Registers a simulation running in the background on the default task pool, endFrame waits for it<para/>
+		/// so that the cost of a system that isn't synchronized before the end of the frame is reported within the frame
+		/// </summary>
+		/// <param name="simulation">The task group of the simulation, it must be unregistered before being destroyed</param>
+		/// <see cref="removeSimulation"/>
+		void addSimulation(TaskPool::Group& simulation);
+		/// <summary>Unregisters a simulation, called once it was synchronized</summary>
+		/// <param name="simulation">The task group of the simulation</param>
+		/// <see cref="addSimulation"/>
+		void removeSimulation(TaskPool::Group& simulation);
+		/// <summary>
+		/// Closes the current frame, waiting for the simulations still running in the background and then<para/>
+		/// adjusting the detail level to the frame's cost<para/>
+		/// Called by the Application once per frame
+		/// </summary>
+		/// <see cref="getLastFrameStats"/>
+		void endFrame();
+		/// <summary>Returns what was shed during the last closed frame</summary>
+		/// <returns>The last frame's statistics</returns>
+		inline const Stats& getLastFrameStats() const { return last_frame_stats_; }
+		/// <summary>Returns the budget used by the particle systems</summary>
+		/// <returns>The default budget</returns>
+		static ParticleBudget& getDefault();
+
+	private:
+		sf::Time                      frame_budget_;
+		float                         level_;
+		std::atomic<sf::Int64>        cost_;
+		std::atomic<size_t>           shed_particles_;
+		std::atomic<size_t>           capped_particles_;
+		std::atomic<size_t>           culled_systems_;
+		Stats                         last_frame_stats_;
+		std::vector<TaskPool::Group*> simulations_;
+		std::mutex                    simulations_mutex_;
+	};
+}
+#endif
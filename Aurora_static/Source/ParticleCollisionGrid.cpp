@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <cmath>
+
+#include "MaterialNode.h"
+#include "ParticleCollisionGrid.h"
+#include "ParticleSystem.h"
+
+namespace au
+{
+	const ParticleCollisionGrid::ColliderId ParticleCollisionGrid::NullCollider;
+
+	ParticleCollisionGrid::ParticleCollisionGrid(float cell_size, size_t bucket_count)
+		: colliders_()
+		, bounds_()
+		, free_colliders_()
+		, buckets_()
+		, bucket_mask_(0)
+		, inverse_cell_size_(1.f / cell_size)
+		, rebucketed_colliders_(0)
+		, particle_systems_()
+	{
+		setEventSubscriptions({});
+		size_t buckets = 1;
+		while (buckets < bucket_count)
+			buckets <<= 1;
+		buckets_.resize(buckets);
+		bucket_mask_ = buckets - 1;
+	}
+
+	ParticleCollisionGrid::ColliderId ParticleCollisionGrid::addCollider(const MaterialNode& node, bool dynamic)
+	{
+		const ColliderId collider = createCollider(node.getGlobalBounds());
+		colliders_[collider].node = node.getHandle();
+		colliders_[collider].dynamic = dynamic;
+		return collider;
+	}
+
+	ParticleCollisionGrid::ColliderId ParticleCollisionGrid::addCollider(const sf::FloatRect& bounds)
+	{
+		return createCollider(bounds);
+	}
+
+	void ParticleCollisionGrid::removeCollider(ColliderId collider)
+	{
+		if (collider < 0 || static_cast<size_t>(collider) >= colliders_.size() || !colliders_[collider].alive)
+			return;
+
+		synchronizeParticleSystems();
+		eraseFromBuckets(collider);
+		colliders_[collider].alive = false;
+		free_colliders_.push_back(collider);
+	}
+
+	const sf::FloatRect* ParticleCollisionGrid::findCollider(sf::Vector2f point) const
+	{
+		const int x = static_cast<int>(std::floor(point.x * inverse_cell_size_));
+		const int y = static_cast<int>(std::floor(point.y * inverse_cell_size_));
+		for (ColliderId collider : buckets_[getBucket(x, y)])
+			if (bounds_[collider].contains(point))
+				return &bounds_[collider];
+		return nullptr;
+	}
+
+	void ParticleCollisionGrid::collide(const ParticleSpan& span, float dt, CollisionResponse response, float restitution) const
+	{
+		for (size_t i = 0; i < span.count; ++i) {
+			const sf::FloatRect* bounds = findCollider(sf::Vector2f(span.position_x[i], span.position_y[i]));
+			if (!bounds)
+				continue;
+
+			switch (response) {
+			case CollisionResponse::Bounce: {
+				// The side crossed is the one the particle was outside of before moving
+				const float previous_x = span.position_x[i] - span.velocity_x[i] * dt;
+				if (previous_x < bounds->left || previous_x >= bounds->left + bounds->width) {
+					span.position_x[i] = span.velocity_x[i] > 0.f ? bounds->left : bounds->left + bounds->width;
+					span.velocity_x[i] *= -restitution;
+				}
+				else {
+					span.position_y[i] = span.velocity_y[i] > 0.f ? bounds->top : bounds->top + bounds->height;
+					span.velocity_y[i] *= -restitution;
+				}
+				break;
+			}
+			case CollisionResponse::Kill:
+				span.lifetime[i] = 0.f;
+				break;
+			case CollisionResponse::Stick:
+				span.velocity_x[i] = span.velocity_y[i] = 0.f;
+				span.acceleration_x[i] = span.acceleration_y[i] = 0.f;
+				break;
+			}
+		}
+	}
+
+	void ParticleCollisionGrid::addParticleSystem(const ParticleSystem& system) const
+	{
+		particle_systems_.push_back(system.getHandle());
+	}
+
+	void ParticleCollisionGrid::removeParticleSystem(const ParticleSystem& system) const
+	{
+		const auto itr = std::find(particle_systems_.begin(), particle_systems_.end(), system.getHandle());
+		if (itr != particle_systems_.end()) {
+			*itr = particle_systems_.back();
+			particle_systems_.pop_back();
+		}
+	}
+
+	void ParticleCollisionGrid::synchronizeParticleSystems() const
+	{
+		for (size_t i = 0; i < particle_systems_.size();) {
+			const SceneNode* system = SceneNode::resolve(particle_systems_[i]);
+			if (system) {
+				static_cast<const ParticleSystem*>(system)->synchronize();
+				++i;
+			}
+			else {
+				particle_systems_[i] = particle_systems_.back();
+				particle_systems_.pop_back();
+			}
+		}
+	}
+
+	ParticleCollisionGrid::ColliderId ParticleCollisionGrid::createCollider(const sf::FloatRect& bounds)
+	{
+		synchronizeParticleSystems();
+
+		ColliderId collider;
+		if (!free_colliders_.empty()) {
+			collider = free_colliders_.back();
+			free_colliders_.pop_back();
+		}
+		else {
+			collider = static_cast<ColliderId>(colliders_.size());
+			colliders_.emplace_back();
+			bounds_.emplace_back();
+		}
+
+		colliders_[collider].node = SceneNode::Handle();
+		colliders_[collider].cells = getCells(bounds);
+		colliders_[collider].dynamic = false;
+		colliders_[collider].alive = true;
+		bounds_[collider] = bounds;
+		insertIntoBuckets(collider);
+		return collider;
+	}
+
+	sf::IntRect ParticleCollisionGrid::getCells(const sf::FloatRect& bounds) const
+	{
+		const int left = static_cast<int>(std::floor(bounds.left * inverse_cell_size_));
+		const int top = static_cast<int>(std::floor(bounds.top * inverse_cell_size_));
+		const int right = static_cast<int>(std::floor((bounds.left + bounds.width) * inverse_cell_size_));
+		const int bottom = static_cast<int>(std::floor((bounds.top + bounds.height) * inverse_cell_size_));
+		return sf::IntRect(left, top, right - left, bottom - top);
+	}
+
+	void ParticleCollisionGrid::insertIntoBuckets(ColliderId collider)
+	{
+		// Cells hashed into the same bucket only store the collider once
+		const sf::IntRect& cells = colliders_[collider].cells;
+		for (int y = cells.top; y <= cells.top + cells.height; ++y)
+			for (int x = cells.left; x <= cells.left + cells.width; ++x) {
+				std::vector<ColliderId>& bucket = buckets_[getBucket(x, y)];
+				if (std::find(bucket.begin(), bucket.end(), collider) == bucket.end())
+					bucket.push_back(collider);
+			}
+	}
+
+	void ParticleCollisionGrid::eraseFromBuckets(ColliderId collider)
+	{
+		const sf::IntRect& cells = colliders_[collider].cells;
+		for (int y = cells.top; y <= cells.top + cells.height; ++y)
+			for (int x = cells.left; x <= cells.left + cells.width; ++x) {
+				std::vector<ColliderId>& bucket = buckets_[getBucket(x, y)];
+				const auto itr = std::find(bucket.begin(), bucket.end(), collider);
+				if (itr != bucket.end()) {
+					*itr = bucket.back();
+					bucket.pop_back();
+				}
+			}
+	}
+
+	void ParticleCollisionGrid::updateCurrent(sf::Time)
+	{
+		// The simulations of the systems that weren't drawn may still be colliding
+		synchronizeParticleSystems();
+
+		rebucketed_colliders_ = 0;
+		for (ColliderId collider = 0; collider < static_cast<ColliderId>(colliders_.size()); ++collider) {
+			Collider& entry = colliders_[collider];
+			if (!entry.alive || entry.node == SceneNode::Handle())
+				continue;
+
+			// Static nodes are only checked for liveness, their bounds aren't polled again
+			const MaterialNode* node = static_cast<const MaterialNode*>(SceneNode::resolve(entry.node));
+			if (!node) {
+				removeCollider(collider);
+				continue;
+			}
+			if (!entry.dynamic)
+				continue;
+
+			bounds_[collider] = node->getGlobalBounds();
+			const sf::IntRect cells(getCells(bounds_[collider]));
+			if (cells != entry.cells) {
+				eraseFromBuckets(collider);
+				entry.cells = cells;
+				insertIntoBuckets(collider);
+				rebucketed_colliders_++;
+			}
+		}
+	}
+}
@@ -0,0 +1,136 @@
+#ifndef Aurora_ParticleCollisionGrid_H_
+#define Aurora_ParticleCollisionGrid_H_
+
+#include <vector>
+
+#include <SFML/Config.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include "ParticleStorage.h"
+#include "SceneNode.h"
+
+namespace au
+{
+	class MaterialNode;
+	class ParticleSystem;
+
+	/// <summary>How particles react when they enter a collider</summary>
+	enum class CollisionResponse { Bounce, Kill, Stick };
+
+	/// <summary>
+	/// SceneNode derivative bucketing the bounds of colliders into a uniform spatial hash grid<para/>
+	/// Colliders are material nodes or fixed rectangles, every collider is stored in the buckets of the cells<para/>
+	/// it overlaps so that a particle only tests the colliders of its own cell, colliding costs in proportion<para/>
+	/// to the amount of particles whatever the amount of colliders<para/>
+	/// The bounds of dynamic colliders are polled each update, only the colliders that left their cells are rebucketed<para/>
+	/// The grid must be updated before the particle systems colliding with it, it must be attached before them<para/>
+	/// The particle systems colliding with the grid are synchronized before its colliders are modified
+	/// </summary>
+	class ParticleCollisionGrid : public SceneNode
+	{
+		friend class ParticleSystem;
+
+	public:
+		using ColliderId = sf::Int32;
+		/// <summary>Value used for invalid colliders</summary>
+		static const ColliderId NullCollider = -1;
+
+	public:
+		/// <summary>Constructs the grid</summary>
+		/// <param name="cell_size">The width and height of the cells, about the size of the colliders</param>
+		/// <param name="bucket_count">The amount of buckets the cells are hashed into (rounded up to a power of 2)</param>
+		explicit ParticleCollisionGrid(float cell_size = 64.f, size_t bucket_count = 4096);
+	public:
+		/// <summary>Adds a material node's global bounds as a collider, the collider is removed once the node is destroyed</summary>
+		/// <param name="node">The material node</param>
+		/// <param name="dynamic">True if the node moves, false to never poll its bounds again</param>
+		/// <returns>The collider's id</returns>
+		/// <see cref="removeCollider"/>
+		ColliderId addCollider(const MaterialNode& node, bool dynamic = true);
+		/// <summary>Adds a fixed rectangle as a collider</summary>
+		/// <param name="bounds">The collider's bounds</param>
+		/// <returns>The collider's id</returns>
+		/// <see cref="removeCollider"/>
+		ColliderId addCollider(const sf::FloatRect& bounds);
+		/// <summary>Removes a collider, its id may be reused</summary>
+		/// <param name="collider">The collider's id</param>
+		/// <see cref="addCollider"/>
+		void removeCollider(ColliderId collider);
+		/// <summary>Returns the collider containing a point</summary>
+		/// <param name="point">The point</param>
+		/// <returns>The bounds of the first collider found, nullptr if the point isn't inside any collider</returns>
+		const sf::FloatRect* findCollider(sf::Vector2f point) const;
+		/// <summary>
+		/// Makes the particles situated inside a collider react to it, the particles are expected to have moved during<para/>
+		/// the frame already, a bouncing particle is reflected along the side it crossed and placed on it<para/>
+		/// May be called concurrently for disjoint spans
+		/// </summary>
+		/// <param name="span">The particles, expressed in the colliders' space</param>
+		/// <param name="dt">Time passed in current frame (in seconds)</param>
+		/// <param name="response">How the particles react</param>
+		/// <param name="restitution">The ratio of velocity kept by bouncing particles</param>
+		void collide(const ParticleSpan& span, float dt, CollisionResponse response, float restitution) const;
+		/// <summary>Returns the amount of colliders</summary>
+		/// <returns>The amount of colliders</returns>
+		inline size_t getColliderCount() const { return colliders_.size() - free_colliders_.size(); }
+		/// <summary>Returns the amount of dynamic colliders that left their cells during the last update</summary>
+		/// <returns>The amount of rebucketed colliders</returns>
+		inline size_t getRebucketedColliderCount() const { return rebucketed_colliders_; }
+	private:
+		struct Collider
+		{
+			SceneNode::Handle node;         // Invalid for fixed rectangles
+			sf::IntRect       cells;        // The cells overlapped, right and bottom included
+			bool              dynamic;
+			bool              alive;
+		};
+
+		/// <summary>Registers a particle system colliding with the grid</summary>
+		/// <param name="system">The particle system</param>
+		void addParticleSystem(const ParticleSystem& system) const;
+		/// <summary>Unregisters a particle system that no longer collides with the grid</summary>
+		/// <param name="system">The particle system</param>
+		void removeParticleSystem(const ParticleSystem& system) const;
+		/// <summary>Waits for the simulations of the particle systems colliding with the grid, which read the buckets and bounds</summary>
+		void synchronizeParticleSystems() const;
+		/// <summary>Stores a collider's bounds and buckets it</summary>
+		/// <param name="bounds">The collider's bounds</param>
+		/// <returns>The collider's id</returns>
+		ColliderId createCollider(const sf::FloatRect& bounds);
+		/// <summary>Returns the cells overlapped by bounds</summary>
+		/// <param name="bounds">The bounds</param>
+		/// <returns>The cells, right and bottom included</returns>
+		sf::IntRect getCells(const sf::FloatRect& bounds) const;
+		/// <summary>Returns the bucket of a cell</summary>
+		/// <param name="x">The cell's column</param>
+		/// <param name="y">The cell's row</param>
+		/// <returns>The bucket's index</returns>
+		inline size_t getBucket(int x, int y) const
+		{
+			return ((static_cast<sf::Uint32>(x) * 73856093u) ^ (static_cast<sf::Uint32>(y) * 19349663u)) & bucket_mask_;
+		}
+		/// <summary>Adds a collider to the buckets of its cells</summary>
+		/// <param name="collider">The collider's id</param>
+		void insertIntoBuckets(ColliderId collider);
+		/// <summary>Removes a collider from the buckets of its cells</summary>
+		/// <param name="collider">The collider's id</param>
+		void eraseFromBuckets(ColliderId collider);
+		/// <summary>
+		/// Polls the bounds of the dynamic colliders and rebuckets the ones that left their cells<para/>
+		/// The colliders of destroyed nodes are removed, static or not
+		/// </summary>
+		/// <param name="dt">Time passed in current frame</param>
+		virtual void updateCurrent(sf::Time dt) override;
+
+	private:
+		std::vector<Collider>                colliders_;
+		std::vector<sf::FloatRect>           bounds_;            // Indexed like colliders_, read per particle
+		std::vector<ColliderId>              free_colliders_;
+		std::vector<std::vector<ColliderId>> buckets_;
+		size_t                               bucket_mask_;
+		float                                inverse_cell_size_;
+		size_t                               rebucketed_colliders_;
+		mutable std::vector<Handle>          particle_systems_;   // Destroyed systems are removed once they no longer resolve
+	};
+}
+#endif
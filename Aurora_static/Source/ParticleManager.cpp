@@ -0,0 +1,334 @@
+#include <algorithm>
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include "ParticleManager.h"
+#include "RenderQueue.h"
+
+namespace au
+{
+	ParticleManager::ParticleManager(size_t max_particles)
+		: max_particles_(max_particles)
+		, next_serial_(1)
+		, span_affector_()
+		, integration_active_(false)
+		, fade_active_(true)
+		, parallel_simulation_(false)
+		, simulation_group_()
+		, simulation_budgeted_(false)
+		, priority_(ParticleBudget::Priority::Normal)
+		, detail_scale_(1.f)
+		, full_detail_particles_(0)
+		, shed_accumulator_(0.f)
+		, capped_particles_(0)
+	{
+		setEventSubscriptions({});
+	}
+
+	ParticleManager::~ParticleManager()
+	{
+		synchronize();
+	}
+
+	ParticleManager::EmitterHandle ParticleManager::createEmitter(const EmitterSettings& settings)
+	{
+		synchronize();
+		sf::Uint32 index;
+		if (!free_emitters_.empty()) {
+			index = free_emitters_.back();
+			free_emitters_.pop_back();
+		}
+		else {
+			index = static_cast<sf::Uint32>(emitters_.size());
+			emitters_.emplace_back();
+			emitters_.back().generation = 0;
+			texture_coords_.emplace_back();
+			particle_counts_.emplace_back();
+			serials_.emplace_back();
+		}
+
+		Emitter& emitter = emitters_[index];
+		emitter.settings = settings;
+		emitter.batch = acquireBatch(settings.texture, settings.blend_mode);
+		particle_counts_[index] = 0;
+		emitter.emission_accumulator = 0.f;
+		emitter.elapsed = sf::Time::Zero;
+		emitter.alive = true;
+		emitter.emitting = settings.emission_rate > 0.f;
+
+		sf::FloatRect rect(settings.texture_rect);
+		if (settings.texture && (rect.width == 0.f || rect.height == 0.f))
+			rect = sf::FloatRect(sf::Vector2f(0.f, 0.f), static_cast<sf::Vector2f>(settings.texture->getSize()));
+		texture_coords_[index] = rect;
+		serials_[index] = next_serial_++;
+
+		emitParticles(index, settings.burst);
+
+		EmitterHandle handle;
+		handle.index = index;
+		handle.generation = emitter.generation;
+		return handle;
+	}
+
+	void ParticleManager::stopEmitter(EmitterHandle emitter)
+	{
+		if (Emitter* resolved = resolve(emitter))
+			resolved->emitting = false;
+	}
+
+	bool ParticleManager::isEmitterAlive(EmitterHandle emitter) const
+	{
+		return emitter.index < emitters_.size() && emitters_[emitter.index].alive
+		    && emitters_[emitter.index].generation == emitter.generation;
+	}
+
+	void ParticleManager::setEmitterPosition(EmitterHandle emitter, sf::Vector2f position)
+	{
+		if (Emitter* resolved = resolve(emitter))
+			resolved->settings.position = position;
+	}
+
+	size_t ParticleManager::emitBurst(EmitterHandle emitter, size_t count)
+	{
+		synchronize();
+		return resolve(emitter) ? emitParticles(emitter.index, count) : 0;
+	}
+
+	void ParticleManager::setSpanAffector(const std::function<void(const ParticleSpan&, sf::Time)>& affector)
+	{
+		synchronize();
+		span_affector_ = affector;
+	}
+
+	void ParticleManager::setMaxParticles(size_t max)
+	{
+		max_particles_ = max;
+	}
+
+	size_t ParticleManager::getParticleCount() const
+	{
+		synchronize();
+		return countParticles();
+	}
+
+	void ParticleManager::activateParallelSimulation(bool flag)
+	{
+		synchronize();
+		parallel_simulation_ = flag;
+	}
+
+	void ParticleManager::synchronize() const
+	{
+		TaskPool::getDefault().wait(simulation_group_);
+		if (simulation_budgeted_.exchange(false))
+			ParticleBudget::getDefault().removeSimulation(simulation_group_);
+	}
+
+	ParticleManager::Emitter* ParticleManager::resolve(EmitterHandle handle)
+	{
+		return isEmitterAlive(handle) ? &emitters_[handle.index] : nullptr;
+	}
+
+	size_t ParticleManager::acquireBatch(const sf::Texture* texture, const sf::BlendMode& blend_mode)
+	{
+		for (size_t i = 0; i < batches_.size(); ++i)
+			if (batches_[i].texture == texture && batches_[i].blend_mode == blend_mode)
+				return i;
+
+		batches_.emplace_back();
+		Batch& batch = batches_.back();
+		batch.texture = texture;
+		batch.blend_mode = blend_mode;
+		batch.vertex_count = 0;
+		return batches_.size() - 1;
+	}
+
+	size_t ParticleManager::countParticles() const
+	{
+		size_t count = 0;
+		for (const Batch& batch : batches_)
+			count += batch.particles.size();
+		return count;
+	}
+
+	void ParticleManager::releaseEmitters()
+	{
+		for (sf::Uint32 i = 0; i < emitters_.size(); ++i) {
+			Emitter& emitter = emitters_[i];
+			if (emitter.alive && !emitter.emitting && particle_counts_[i] == 0) {
+				emitter.alive = false;
+				emitter.generation++;
+				emitter.settings.initializer = nullptr;
+				free_emitters_.push_back(i);
+			}
+		}
+	}
+
+	size_t ParticleManager::emitParticles(sf::Uint32 index, size_t count)
+	{
+		Emitter& emitter = emitters_[index];
+		const size_t particle_count = countParticles();
+		if (max_particles_ != 0)
+			count = std::min(count, max_particles_ - std::min(particle_count, max_particles_));
+
+		// The max particles are scaled by the budget's detail level
+		const size_t scaled_max = ParticleBudget::scaleMaxParticles(max_particles_, full_detail_particles_, detail_scale_);
+		if (scaled_max != 0) {
+			const size_t scaled_allowed = scaled_max - std::min(particle_count, scaled_max);
+			if (count > scaled_allowed) {
+				capped_particles_ += count - scaled_allowed;
+				count = scaled_allowed;
+			}
+		}
+		if (count == 0 || !emitter.settings.initializer)
+			return 0;
+
+		ParticleStorage& particles = batches_[emitter.batch].particles;
+		const size_t first = particles.append(count);
+		const ParticleSpan span(particles.getSpan(first, count));
+		for (size_t i = 0; i < count; ++i) {
+			Particle particle(emitter.settings.initializer());
+			particle.position = emitter.settings.position;
+			particles.initialize(first + i, particle);
+			span.tag[i] = index;
+		}
+
+		particle_counts_[index] += static_cast<sf::Uint32>(count);
+		return count;
+	}
+
+	void ParticleManager::computeVertices(Batch& batch, TaskPool* pool)
+	{
+		const size_t count = batch.particles.size();
+		batch.vertex_count = count * 4;
+		if (batch.vertices.size() < batch.vertex_count) {
+			batch.vertices.resize(batch.vertex_count);
+			batch.quad_serials.resize(count, 0);
+		}
+
+		batch.particles.forEachChunk(pool, [this, &batch](const ParticleSpan& span, size_t first) {
+			if (fade_active_)
+				ParticleStorage::computeFade(span);
+			ParticleStorage::computeQuads(span, batch.vertices.data() + first * 4, fade_active_);
+
+			// Particles are moved around as others expire, a quad's texture coordinates are only
+			// rewritten once it holds the particle of another emitter
+			sf::Vertex* quad = batch.vertices.data() + first * 4;
+			sf::Uint32* quad_serial = batch.quad_serials.data() + first;
+			for (size_t i = 0; i < span.count; ++i, quad += 4) {
+				const sf::Uint32 emitter = span.tag[i];
+				if (quad_serial[i] == serials_[emitter])
+					continue;
+
+				const sf::FloatRect& rect = texture_coords_[emitter];
+				quad[0].texCoords = sf::Vector2f(rect.left, rect.top);
+				quad[1].texCoords = sf::Vector2f(rect.left + rect.width, rect.top);
+				quad[2].texCoords = sf::Vector2f(rect.left + rect.width, rect.top + rect.height);
+				quad[3].texCoords = sf::Vector2f(rect.left, rect.top + rect.height);
+				quad_serial[i] = serials_[emitter];
+			}
+		});
+
+		const ParticleSpan span(batch.particles.getSpan());
+		for (size_t i = 0; i < span.count; ++i)
+			particle_counts_[span.tag[i]]++;
+	}
+
+	void ParticleManager::simulateBatch(Batch& batch, sf::Time dt, TaskPool* pool)
+	{
+		const float seconds = dt.asSeconds();
+		batch.particles.forEachChunk(pool, [this, dt, seconds](const ParticleSpan& span, size_t) {
+			if (span_affector_)
+				span_affector_(span, dt);
+			if (integration_active_)
+				ParticleStorage::integrate(span, seconds);
+			ParticleStorage::age(span, seconds);
+		});
+		batch.particles.removeExpired();
+
+		computeVertices(batch, pool);
+	}
+
+	void ParticleManager::updateCurrent(sf::Time dt)
+	{
+		synchronize();
+		sf::Clock clock;
+		releaseEmitters();
+
+		ParticleBudget& budget = ParticleBudget::getDefault();
+		detail_scale_ = budget.getScale(priority_);
+
+		const float seconds = dt.asSeconds();
+		for (sf::Uint32 i = 0; i < emitters_.size(); ++i) {
+			Emitter& emitter = emitters_[i];
+			if (!emitter.alive || !emitter.emitting)
+				continue;
+
+			const float emitted = emitter.settings.emission_rate * seconds;
+			emitter.emission_accumulator += emitted * detail_scale_;
+			const size_t count = static_cast<size_t>(emitter.emission_accumulator);
+			emitter.emission_accumulator -= static_cast<float>(count);
+			shed_accumulator_ += emitted * (1.f - detail_scale_);
+			emitParticles(i, count);
+
+			emitter.elapsed += dt;
+			if (emitter.settings.duration != sf::Time::Zero && emitter.elapsed >= emitter.settings.duration)
+				emitter.emitting = false;
+		}
+
+		std::fill(particle_counts_.begin(), particle_counts_.end(), 0);
+
+		if (detail_scale_ >= 1.f)
+			full_detail_particles_ = countParticles();
+
+		// The fractions of shed particles are carried over to the next updates
+		const size_t shed = static_cast<size_t>(shed_accumulator_);
+		shed_accumulator_ -= static_cast<float>(shed);
+		budget.reportShedding(shed, capped_particles_, false);
+		capped_particles_ = 0;
+
+		// Every emitter belongs to a single batch, the batches' tasks don't share any data
+		if (parallel_simulation_) {
+			// The simulation may outlast the frame if the manager isn't drawn
+			if (budget.isActive() && !simulation_budgeted_.exchange(true))
+				budget.addSimulation(simulation_group_);
+			budget.reportCost(clock.getElapsedTime());
+
+			TaskPool& pool = TaskPool::getDefault();
+			for (Batch& batch : batches_)
+				pool.submit(simulation_group_, [this, &batch, dt, &pool]() {
+					sf::Clock clock;
+					simulateBatch(batch, dt, &pool);
+					ParticleBudget::getDefault().reportCost(clock.getElapsedTime());
+				});
+		}
+		else {
+			for (Batch& batch : batches_)
+				simulateBatch(batch, dt, nullptr);
+			budget.reportCost(clock.getElapsedTime());
+		}
+	}
+
+	void ParticleManager::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
+	{
+		synchronize();
+		for (const Batch& batch : batches_)
+			if (batch.vertex_count > 0) {
+				states.texture = batch.texture;
+				states.blendMode = batch.blend_mode;
+				target.draw(batch.vertices.data(), batch.vertex_count, sf::Quads, states);
+			}
+	}
+
+	void ParticleManager::enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		synchronize();
+		for (const Batch& batch : batches_)
+			if (batch.vertex_count > 0) {
+				states.texture = batch.texture;
+				states.blendMode = batch.blend_mode;
+				queue.submit(batch.vertices.data(), batch.vertex_count, sf::Quads, states, layer);
+			}
+	}
+}
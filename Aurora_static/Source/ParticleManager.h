@@ -0,0 +1,230 @@
+#ifndef Aurora_ParticleManager_H_
+#define Aurora_ParticleManager_H_
+
+#include <atomic>
+#include <functional>
+
+#include <SFML/Graphics/BlendMode.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+
+#include "ParticleBudget.h"
+#include "ParticleStorage.h"
+#include "SceneNode.h"
+
+namespace au
+{
+	/// <summary>
+	/// Scene node hosting many lightweight emitters in pooled particle storages<para/>
+	/// Emitters sharing a texture and a blend mode share a batch, every batch is updated in a single pass<para/>
+	/// and drawn with a single draw call, each emitter uses its own sub-rectangle of the batch's texture atlas<para/>
+	/// Emitters are released by the update following the expiry of their particles once they stopped emitting<para/>
+	/// The cost of every update is reported to the default ParticleBudget, which scales the emitters' emission<para/>
+	/// and the max particles under pressure
+	/// </summary>
+	class ParticleManager : public SceneNode
+	{
+	public:
+		/// <summary>Generation-checked handle of an emitter, the handle of a released emitter no longer resolves</summary>
+		struct EmitterHandle
+		{
+			sf::Uint32 index      = static_cast<sf::Uint32>(-1);
+			sf::Uint32 generation = 0;
+
+			inline bool operator==(const EmitterHandle& other) const { return index == other.index && generation == other.generation; }
+			inline bool operator!=(const EmitterHandle& other) const { return !(*this == other); }
+		};
+
+		/// <summary>
+		/// Description of an emitter<para/>
+		/// An emitter without emission rate stops emitting after its initial burst, an emitter without duration<para/>
+		/// emits until stopEmitter is called
+		/// </summary>
+		struct EmitterSettings
+		{
+			std::function<Particle()> initializer;
+			const sf::Texture*        texture       = nullptr;
+			sf::IntRect               texture_rect;                 // The whole texture if empty
+			sf::BlendMode             blend_mode    = sf::BlendAlpha;
+			sf::Vector2f              position;
+			float                     emission_rate = 0.f;          // Particles per second
+			size_t                    burst         = 0;            // Particles emitted on creation
+			sf::Time                  duration      = sf::Time::Zero;
+		};
+
+	public:
+		/// <summary>Constructs the particle manager</summary>
+		/// <param name="max_particles">The max particles shared by every emitter, 0 for no limit</param>
+		explicit ParticleManager(size_t max_particles = 0);
+		/// <summary>Waits for the particles' simulation to finish</summary>
+		virtual ~ParticleManager();
+	public:
+		/// <summary>Creates an emitter, reusing a released one if available</summary>
+		/// <param name="settings">The emitter's description</param>
+		/// <returns>The emitter's handle</returns>
+		/// <see cref="stopEmitter"/>
+		EmitterHandle createEmitter(const EmitterSettings& settings);
+		/// <summary>Stops an emitter's emission, it's released once its particles expired</summary>
+		/// <param name="emitter">The emitter's handle</param>
+		/// <see cref="createEmitter"/>
+		void stopEmitter(EmitterHandle emitter);
+		/// <summary>Checks if an emitter wasn't released</summary>
+		/// <param name="emitter">The emitter's handle</param>
+		/// <returns>True if the emitter is alive, false otherwise</returns>
+		bool isEmitterAlive(EmitterHandle emitter) const;
+		/// <summary>Moves an emitter, its particles already emitted aren't moved</summary>
+		/// <param name="emitter">The emitter's handle</param>
+		/// <param name="position">The emitter's new position</param>
+		void setEmitterPosition(EmitterHandle emitter, sf::Vector2f position);
+		/// <summary>
+		/// Emits particles from an emitter at once, whether it stopped emitting or not<para/>
+		/// The particles are drawn once the manager was updated
+		/// </summary>
+		/// <param name="emitter">The emitter's handle</param>
+		/// <param name="count">The amount of particles, limited by the max particles</param>
+		/// <returns>The amount of particles emitted</returns>
+		size_t emitBurst(EmitterHandle emitter, size_t count);
+		/// <summary>Sets the span affector applied to every chunk of every batch once per update</summary>
+		/// <param name="affector">An std::function that takes in a ParticleSpan and an sf::Time</param>
+		void setSpanAffector(const std::function<void(const ParticleSpan&, sf::Time)>& affector);
+		/// <summary>(De)Activates the built-in integration, applied after the span affector</summary>
+		/// <param name="flag">True to activate the integration, false otherwise</param>
+		inline void activateIntegration(bool flag = true) { synchronize(); integration_active_ = flag; }
+		/// <summary>(De)Activates the built-in fade, the particles' alpha is multiplied by the ratio of their remaining lifetime</summary>
+		/// <param name="flag">True to activate the fade, false otherwise</param>
+		inline void activateFade(bool flag = true) { synchronize(); fade_active_ = flag; }
+		/// <summary>Sets the max particles shared by every emitter</summary>
+		/// <param name="max">The max particles, 0 for no limit</param>
+		/// <see cref="getMaxParticles"/>
+		void setMaxParticles(size_t max);
+		/// <summary>Returns the max particles shared by every emitter</summary>
+		/// <returns>The max particles, 0 for no limit</returns>
+		/// <see cref="setMaxParticles"/>
+		inline size_t getMaxParticles() const { return max_particles_; }
+		/// <summary>Returns the amount of living particles of every emitter</summary>
+		/// <returns>The amount of particles</returns>
+		size_t getParticleCount() const;
+		/// <summary>Returns the amount of emitters that weren't released</summary>
+		/// <returns>The amount of emitters</returns>
+		inline size_t getEmitterCount() const { return emitters_.size() - free_emitters_.size(); }
+		/// <summary>Returns the amount of batches, each batch is drawn with a single draw call</summary>
+		/// <returns>The amount of batches</returns>
+		inline size_t getBatchCount() const { return batches_.size(); }
+		/// <summary>
+		/// (De)Activates the parallel simulation, the batches and their chunks of particles are then simulated<para/>
+		/// on the default task pool concurrently with the rest of the frame until the particles are drawn, queried or<para/>
+		/// modified. The span affector is called concurrently from several worker threads, each with its own chunk<para/>
+		/// The initializers are still called during the update, the results don't depend on the amount of threads
+		/// </summary>
+		/// <param name="flag">True to activate the parallel simulation, false otherwise</param>
+		void activateParallelSimulation(bool flag = true);
+		/// <summary>Waits for the simulation started by the last update to finish, called before the particles are accessed</summary>
+		void synchronize() const;
+		/// <summary>
+		/// Sets how much of the emitters' detail is shed while the default particle budget is under pressure<para/>
+		/// Degraded managers emit fewer particles and are limited to fewer particles, unlimited managers are limited<para/>
+		/// relative to their particle count at full detail
+		/// </summary>
+		/// <param name="priority">The manager's priority, Priority::Critical to never degrade the emitters</param>
+		/// <see cref="getPriority"/>
+		inline void setPriority(ParticleBudget::Priority priority) { priority_ = priority; }
+		/// <summary>Returns how much of the emitters' detail is shed while the default particle budget is under pressure</summary>
+		/// <returns>The manager's priority</returns>
+		/// <see cref="setPriority"/>
+		inline ParticleBudget::Priority getPriority() const { return priority_; }
+	private:
+		struct Emitter
+		{
+			EmitterSettings settings;
+			size_t          batch;
+			float           emission_accumulator;
+			sf::Time        elapsed;
+			sf::Uint32      generation;
+			bool            alive;
+			bool            emitting;
+		};
+
+		struct Batch
+		{
+			const sf::Texture*      texture;
+			sf::BlendMode           blend_mode;
+			ParticleStorage         particles;
+			std::vector<sf::Vertex> vertices;
+			std::vector<sf::Uint32> quad_serials;   // Serial of the emitter whose texture coordinates each quad holds
+			size_t                  vertex_count;
+		};
+
+		/// <summary>Returns the emitter of a handle</summary>
+		/// <param name="handle">The emitter's handle</param>
+		/// <returns>The emitter, nullptr if it was released</returns>
+		Emitter* resolve(EmitterHandle handle);
+		/// <summary>Returns the batch of a texture and a blend mode, it's created if it doesn't exist</summary>
+		/// <param name="texture">The batch's texture</param>
+		/// <param name="blend_mode">The batch's blend mode</param>
+		/// <returns>The batch's index</returns>
+		size_t acquireBatch(const sf::Texture* texture, const sf::BlendMode& blend_mode);
+		/// <summary>Returns the amount of living particles of every batch</summary>
+		/// <returns>The amount of particles</returns>
+		size_t countParticles() const;
+		/// <summary>Releases the emitters that stopped emitting and whose particles expired</summary>
+		void releaseEmitters();
+		/// <summary>Emits particles from an emitter into its batch's storage, they're appended at once and then initialized</summary>
+		/// <param name="index">The emitter's index</param>
+		/// <param name="count">The amount of particles, limited by the max particles scaled by the budget's detail level</param>
+		/// <returns>The amount of particles emitted</returns>
+		size_t emitParticles(sf::Uint32 index, size_t count);
+		/// <summary>
+		/// Rewrites a batch's vertices a chunk at a time and then adds its living particles to the count of their emitter<para/>
+		/// The particles are counted sequentially, the emitters of a batch are only counted by the batch's task
+		/// </summary>
+		/// <param name="batch">The batch</param>
+		/// <param name="pool">The task pool the chunks are processed on, nullptr for the calling thread</param>
+		void computeVertices(Batch& batch, TaskPool* pool);
+		/// <summary>Affects, integrates and ages a batch's particles a chunk at a time, then removes the expired ones</summary>
+		/// <param name="batch">The batch</param>
+		/// <param name="dt">Time passed in current frame</param>
+		/// <param name="pool">The task pool the chunks are processed on, nullptr for the calling thread</param>
+		void simulateBatch(Batch& batch, sf::Time dt, TaskPool* pool);
+		/// <summary>
+		/// Releases the finished emitters and emits particles at the detail level of the default budget, then simulates<para/>
+		/// every batch and reports the update's cost to the budget<para/>
+		/// The batches are simulated in the background if the simulation is parallel
+		/// </summary>
+		/// <param name="dt">Time passed in current frame</param>
+		virtual void updateCurrent(sf::Time dt) override;
+		/// <summary>Draws every batch</summary>
+		/// <param name="target">Render target (window, render texture)</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		virtual void drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const override;
+		/// <summary>Submits every batch to the render queue</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The node's render layer</param>
+		virtual void enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const override;
+
+	private:
+		std::vector<Emitter>                                 emitters_;
+		std::vector<sf::FloatRect>                           texture_coords_;    // Indexed like emitters_, read per particle
+		std::vector<sf::Uint32>                              particle_counts_;   // Indexed like emitters_, written per particle
+		std::vector<sf::Uint32>                              serials_;           // Indexed like emitters_, unique per created emitter
+		std::vector<sf::Uint32>                              free_emitters_;
+		std::vector<Batch>                                   batches_;
+		size_t                                               max_particles_;
+		sf::Uint32                                           next_serial_;
+
+		std::function<void(const ParticleSpan&, sf::Time)>   span_affector_;
+		bool                                                 integration_active_;
+		bool                                                 fade_active_;
+		bool                                                 parallel_simulation_;
+		mutable TaskPool::Group                              simulation_group_;
+		mutable std::atomic<bool>                            simulation_budgeted_;   // Registered to the default budget
+
+		ParticleBudget::Priority                             priority_;
+		float                                                detail_scale_;
+		size_t                                               full_detail_particles_;
+		float                                                shed_accumulator_;
+		size_t                                               capped_particles_;
+	};
+}
+#endif
@@ -0,0 +1,369 @@
+#include <algorithm>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define AURORA_PARTICLE_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define AURORA_PARTICLE_SSE2
+#endif
+
+#include <SFML/Graphics/Vertex.hpp>
+
+#include "ParticleStorage.h"
+
+namespace au
+{
+	namespace
+	{
+		// The vector loops stop at the last full register, the scalar loops handle the remaining particles
+#if defined(AURORA_PARTICLE_AVX)
+		const size_t Lanes = 8;
+#elif defined(AURORA_PARTICLE_SSE2)
+		const size_t Lanes = 4;
+#endif
+
+		// velocity += acceleration * dt, position += velocity * dt
+		void integrateAxis(float* position, float* velocity, const float* acceleration, size_t count, float dt)
+		{
+			size_t i = 0;
+#if defined(AURORA_PARTICLE_AVX)
+			const __m256 step = _mm256_set1_ps(dt);
+			for (; i + Lanes <= count; i += Lanes) {
+				__m256 v = _mm256_add_ps(_mm256_loadu_ps(velocity + i), _mm256_mul_ps(_mm256_loadu_ps(acceleration + i), step));
+				_mm256_storeu_ps(velocity + i, v);
+				_mm256_storeu_ps(position + i, _mm256_add_ps(_mm256_loadu_ps(position + i), _mm256_mul_ps(v, step)));
+			}
+#elif defined(AURORA_PARTICLE_SSE2)
+			const __m128 step = _mm_set1_ps(dt);
+			for (; i + Lanes <= count; i += Lanes) {
+				__m128 v = _mm_add_ps(_mm_loadu_ps(velocity + i), _mm_mul_ps(_mm_loadu_ps(acceleration + i), step));
+				_mm_storeu_ps(velocity + i, v);
+				_mm_storeu_ps(position + i, _mm_add_ps(_mm_loadu_ps(position + i), _mm_mul_ps(v, step)));
+			}
+#endif
+			for (; i < count; ++i) {
+				velocity[i] += acceleration[i] * dt;
+				position[i] += velocity[i] * dt;
+			}
+		}
+	}
+
+	const size_t ParticleStorage::ChunkSize;
+
+	ParticleStorage::ParticleStorage()
+	{
+	}
+
+	void ParticleStorage::add(const Particle& particle)
+	{
+		initialize(append(1), particle);
+	}
+
+	size_t ParticleStorage::append(size_t count)
+	{
+		const size_t first = size();
+		const size_t new_size = first + count;
+		const auto append = [new_size](auto& values) { values.resize(new_size); };
+		append(position_x_);
+		append(position_y_);
+		append(velocity_x_);
+		append(velocity_y_);
+		append(acceleration_x_);
+		append(acceleration_y_);
+		append(size_x_);
+		append(size_y_);
+		append(color_);
+		append(lifetime_);
+		append(inverse_lifetime_);
+		append(fade_);
+		append(tag_);
+		return first;
+	}
+
+	void ParticleStorage::initialize(size_t index, const Particle& particle)
+	{
+		const float lifetime = particle.lifetime.asSeconds();
+
+		set(index, particle);
+		inverse_lifetime_[index] = lifetime > 0.f ? 1.f / lifetime : 0.f;
+		fade_[index] = lifetime > 0.f ? 1.f : 0.f;
+	}
+
+	void ParticleStorage::remove(size_t index)
+	{
+		const size_t last = size() - 1;
+		const auto remove = [index, last](auto& values) {
+			values[index] = values[last];
+			values.pop_back();
+		};
+		remove(position_x_);
+		remove(position_y_);
+		remove(velocity_x_);
+		remove(velocity_y_);
+		remove(acceleration_x_);
+		remove(acceleration_y_);
+		remove(size_x_);
+		remove(size_y_);
+		remove(color_);
+		remove(lifetime_);
+		remove(inverse_lifetime_);
+		remove(fade_);
+		remove(tag_);
+	}
+
+	size_t ParticleStorage::removeExpired()
+	{
+		// The particle moved into a removed particle's slot is checked before moving on
+		const size_t count = size();
+		for (size_t i = 0; i < size(); )
+			if (lifetime_[i] <= 0.f)
+				remove(i);
+			else
+				++i;
+		return count - size();
+	}
+
+	void ParticleStorage::clear()
+	{
+		const auto clear = [](auto& values) { values.clear(); };
+		clear(position_x_);
+		clear(position_y_);
+		clear(velocity_x_);
+		clear(velocity_y_);
+		clear(acceleration_x_);
+		clear(acceleration_y_);
+		clear(size_x_);
+		clear(size_y_);
+		clear(color_);
+		clear(lifetime_);
+		clear(inverse_lifetime_);
+		clear(fade_);
+		clear(tag_);
+	}
+
+	void ParticleStorage::reserve(size_t capacity)
+	{
+		const auto reserve = [capacity](auto& values) { values.reserve(capacity); };
+		reserve(position_x_);
+		reserve(position_y_);
+		reserve(velocity_x_);
+		reserve(velocity_y_);
+		reserve(acceleration_x_);
+		reserve(acceleration_y_);
+		reserve(size_x_);
+		reserve(size_y_);
+		reserve(color_);
+		reserve(lifetime_);
+		reserve(inverse_lifetime_);
+		reserve(fade_);
+		reserve(tag_);
+	}
+
+	Particle ParticleStorage::get(size_t index) const
+	{
+		Particle particle;
+		particle.position = sf::Vector2f(position_x_[index], position_y_[index]);
+		particle.size = sf::Vector2f(size_x_[index], size_y_[index]);
+		particle.velocity = sf::Vector2f(velocity_x_[index], velocity_y_[index]);
+		particle.acceleration = sf::Vector2f(acceleration_x_[index], acceleration_y_[index]);
+		particle.color = color_[index];
+		particle.lifetime = sf::seconds(lifetime_[index]);
+		return particle;
+	}
+
+	void ParticleStorage::set(size_t index, const Particle& particle)
+	{
+		position_x_[index] = particle.position.x;
+		position_y_[index] = particle.position.y;
+		size_x_[index] = particle.size.x;
+		size_y_[index] = particle.size.y;
+		velocity_x_[index] = particle.velocity.x;
+		velocity_y_[index] = particle.velocity.y;
+		acceleration_x_[index] = particle.acceleration.x;
+		acceleration_y_[index] = particle.acceleration.y;
+		color_[index] = particle.color;
+		lifetime_[index] = particle.lifetime.asSeconds();
+	}
+
+	ParticleSpan ParticleStorage::getSpan(size_t first, size_t count)
+	{
+		ParticleSpan span;
+		span.count = count;
+		span.position_x = position_x_.data() + first;
+		span.position_y = position_y_.data() + first;
+		span.velocity_x = velocity_x_.data() + first;
+		span.velocity_y = velocity_y_.data() + first;
+		span.acceleration_x = acceleration_x_.data() + first;
+		span.acceleration_y = acceleration_y_.data() + first;
+		span.size_x = size_x_.data() + first;
+		span.size_y = size_y_.data() + first;
+		span.color = color_.data() + first;
+		span.lifetime = lifetime_.data() + first;
+		span.inverse_lifetime = inverse_lifetime_.data() + first;
+		span.fade = fade_.data() + first;
+		span.tag = tag_.data() + first;
+		return span;
+	}
+
+	Particle ParticleStorage::gather(const ParticleSpan& span, size_t index)
+	{
+		Particle particle;
+		particle.position = sf::Vector2f(span.position_x[index], span.position_y[index]);
+		particle.size = sf::Vector2f(span.size_x[index], span.size_y[index]);
+		particle.velocity = sf::Vector2f(span.velocity_x[index], span.velocity_y[index]);
+		particle.acceleration = sf::Vector2f(span.acceleration_x[index], span.acceleration_y[index]);
+		particle.color = span.color[index];
+		particle.lifetime = sf::seconds(span.lifetime[index]);
+		return particle;
+	}
+
+	void ParticleStorage::scatter(const ParticleSpan& span, size_t index, const Particle& particle)
+	{
+		span.position_x[index] = particle.position.x;
+		span.position_y[index] = particle.position.y;
+		span.size_x[index] = particle.size.x;
+		span.size_y[index] = particle.size.y;
+		span.velocity_x[index] = particle.velocity.x;
+		span.velocity_y[index] = particle.velocity.y;
+		span.acceleration_x[index] = particle.acceleration.x;
+		span.acceleration_y[index] = particle.acceleration.y;
+		span.color[index] = particle.color;
+		span.lifetime[index] = particle.lifetime.asSeconds();
+	}
+
+	void ParticleStorage::integrate(const ParticleSpan& span, float dt)
+	{
+		integrateAxis(span.position_x, span.velocity_x, span.acceleration_x, span.count, dt);
+		integrateAxis(span.position_y, span.velocity_y, span.acceleration_y, span.count, dt);
+	}
+
+	void ParticleStorage::age(const ParticleSpan& span, float dt)
+	{
+		float* lifetime = span.lifetime;
+		size_t i = 0;
+#if defined(AURORA_PARTICLE_AVX)
+		const __m256 step = _mm256_set1_ps(dt);
+		for (; i + Lanes <= span.count; i += Lanes)
+			_mm256_storeu_ps(lifetime + i, _mm256_sub_ps(_mm256_loadu_ps(lifetime + i), step));
+#elif defined(AURORA_PARTICLE_SSE2)
+		const __m128 step = _mm_set1_ps(dt);
+		for (; i + Lanes <= span.count; i += Lanes)
+			_mm_storeu_ps(lifetime + i, _mm_sub_ps(_mm_loadu_ps(lifetime + i), step));
+#endif
+		for (; i < span.count; ++i)
+			lifetime[i] -= dt;
+	}
+
+	void ParticleStorage::computeFade(const ParticleSpan& span)
+	{
+		const float* lifetime = span.lifetime;
+		const float* inverse_lifetime = span.inverse_lifetime;
+		float* fade = span.fade;
+		size_t i = 0;
+#if defined(AURORA_PARTICLE_AVX)
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.f);
+		for (; i + Lanes <= span.count; i += Lanes) {
+			__m256 ratio = _mm256_mul_ps(_mm256_loadu_ps(lifetime + i), _mm256_loadu_ps(inverse_lifetime + i));
+			_mm256_storeu_ps(fade + i, _mm256_min_ps(_mm256_max_ps(ratio, zero), one));
+		}
+#elif defined(AURORA_PARTICLE_SSE2)
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.f);
+		for (; i + Lanes <= span.count; i += Lanes) {
+			__m128 ratio = _mm_mul_ps(_mm_loadu_ps(lifetime + i), _mm_loadu_ps(inverse_lifetime + i));
+			_mm_storeu_ps(fade + i, _mm_min_ps(_mm_max_ps(ratio, zero), one));
+		}
+#endif
+		for (; i < span.count; ++i)
+			fade[i] = std::min(std::max(lifetime[i] * inverse_lifetime[i], 0.f), 1.f);
+	}
+
+	void ParticleStorage::computeQuads(const ParticleSpan& span, sf::Vertex* vertices, bool fade)
+	{
+		// The quads' edges are computed a register at a time, then scattered into the interleaved vertices
+		const size_t Block = 8;
+		float left[Block], top[Block], right[Block], bottom[Block];
+
+		for (size_t first = 0; first < span.count; first += Block) {
+			const size_t count = std::min(Block, span.count - first);
+			const float* x = span.position_x + first;
+			const float* y = span.position_y + first;
+			const float* width = span.size_x + first;
+			const float* height = span.size_y + first;
+
+			size_t i = 0;
+#if defined(AURORA_PARTICLE_AVX)
+			const __m256 half = _mm256_set1_ps(0.5f);
+			if (count == Block) {
+				__m256 half_width = _mm256_mul_ps(_mm256_loadu_ps(width), half);
+				__m256 half_height = _mm256_mul_ps(_mm256_loadu_ps(height), half);
+				_mm256_storeu_ps(left, _mm256_sub_ps(_mm256_loadu_ps(x), half_width));
+				_mm256_storeu_ps(right, _mm256_add_ps(_mm256_loadu_ps(x), half_width));
+				_mm256_storeu_ps(top, _mm256_sub_ps(_mm256_loadu_ps(y), half_height));
+				_mm256_storeu_ps(bottom, _mm256_add_ps(_mm256_loadu_ps(y), half_height));
+				i = Block;
+			}
+#elif defined(AURORA_PARTICLE_SSE2)
+			const __m128 half = _mm_set1_ps(0.5f);
+			for (; i + Lanes <= count; i += Lanes) {
+				__m128 half_width = _mm_mul_ps(_mm_loadu_ps(width + i), half);
+				__m128 half_height = _mm_mul_ps(_mm_loadu_ps(height + i), half);
+				_mm_storeu_ps(left + i, _mm_sub_ps(_mm_loadu_ps(x + i), half_width));
+				_mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(x + i), half_width));
+				_mm_storeu_ps(top + i, _mm_sub_ps(_mm_loadu_ps(y + i), half_height));
+				_mm_storeu_ps(bottom + i, _mm_add_ps(_mm_loadu_ps(y + i), half_height));
+			}
+#endif
+			for (; i < count; ++i) {
+				left[i] = x[i] - width[i] * 0.5f;
+				right[i] = x[i] + width[i] * 0.5f;
+				top[i] = y[i] - height[i] * 0.5f;
+				bottom[i] = y[i] + height[i] * 0.5f;
+			}
+
+			sf::Vertex* quad = vertices + first * 4;
+			for (i = 0; i < count; ++i, quad += 4) {
+				sf::Color color = span.color[first + i];
+				if (fade)
+					color.a = static_cast<sf::Uint8>(color.a * span.fade[first + i]);
+
+				quad[0].position = sf::Vector2f(left[i], top[i]);
+				quad[1].position = sf::Vector2f(right[i], top[i]);
+				quad[2].position = sf::Vector2f(right[i], bottom[i]);
+				quad[3].position = sf::Vector2f(left[i], bottom[i]);
+				quad[0].color = quad[1].color = quad[2].color = quad[3].color = color;
+			}
+		}
+	}
+
+	sf::FloatRect ParticleStorage::computeBounds(const ParticleSpan& span)
+	{
+		if (span.count == 0)
+			return sf::FloatRect();
+
+		float left = span.position_x[0], top = span.position_y[0];
+		float right = left, bottom = top;
+		for (size_t i = 0; i < span.count; ++i) {
+			const float half_width = span.size_x[i] * 0.5f;
+			const float half_height = span.size_y[i] * 0.5f;
+			left = std::min(left, span.position_x[i] - half_width);
+			right = std::max(right, span.position_x[i] + half_width);
+			top = std::min(top, span.position_y[i] - half_height);
+			bottom = std::max(bottom, span.position_y[i] + half_height);
+		}
+		return sf::FloatRect(left, top, right - left, bottom - top);
+	}
+
+	const char* ParticleStorage::getInstructionSet()
+	{
+#if defined(AURORA_PARTICLE_AVX)
+		return "AVX";
+#elif defined(AURORA_PARTICLE_SSE2)
+		return "SSE2";
+#else
+		return "Scalar";
+#endif
+	}
+}
@@ -0,0 +1,188 @@
+#ifndef Aurora_ParticleStorage_H_
+#define Aurora_ParticleStorage_H_
+
+#include <algorithm>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Time.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include "TaskPool.h"
+
+namespace sf
+{
+	class Vertex;
+}
+
+namespace au
+{
+	/// <summary>Struct that describes a particle</summary>
+	struct Particle
+	{
+		sf::Vector2f position;
+		sf::Vector2f size;
+		sf::Vector2f velocity;
+		sf::Vector2f acceleration;
+		sf::Color	 color;
+		sf::Time	 lifetime;
+	};
+
+	/// <summary>
+	/// Range of particles of a ParticleStorage, every member points to the range's first element<para/>
+	/// Lifetimes are the remaining seconds, fade ratios go from 1 at spawn to 0 at expiry<para/>
+	/// Tags are free for the storage's owner to use (the ParticleManager class stores the particles' emitter)
+	/// </summary>
+	struct ParticleSpan
+	{
+		size_t       count;
+		float*       position_x;
+		float*       position_y;
+		float*       velocity_x;
+		float*       velocity_y;
+		float*       acceleration_x;
+		float*       acceleration_y;
+		float*       size_x;
+		float*       size_y;
+		sf::Color*   color;
+		float*       lifetime;
+		const float* inverse_lifetime;
+		float*       fade;
+		sf::Uint32*  tag;
+	};
+
+	/// <summary>
+	/// Structure-of-arrays particle storage, every particle attribute is stored in its own array<para/>
+	/// The built-in kernels process whole spans of particles and are vectorized with AVX or SSE2 when<para/>
+	/// the compiler targets them, a scalar fallback is used otherwise
+	/// </summary>
+	class ParticleStorage
+	{
+	public:
+		/// <summary>Amount of particles processed at a time by forEachChunk, small enough for a chunk to remain in cache</summary>
+		static const size_t ChunkSize = 1024;
+
+	public:
+		/// <summary>Default constructor</summary>
+		ParticleStorage();
+	public:
+		/// <summary>Adds a particle at the end of the storage</summary>
+		/// <param name="particle">The particle</param>
+		void add(const Particle& particle);
+		/// <summary>
+		/// Adds uninitialized particles at the end of the storage, every array is resized once<para/>
+		/// The particles must then be initialized through the initialize method
+		/// </summary>
+		/// <param name="count">The amount of particles</param>
+		/// <returns>The index of the first added particle</returns>
+		/// <see cref="initialize"/>
+		size_t append(size_t count);
+		/// <summary>Sets every attribute of a particle, its initial lifetime included and its tag excluded</summary>
+		/// <param name="index">The particle's index</param>
+		/// <param name="particle">The particle</param>
+		/// <see cref="append"/>
+		void initialize(size_t index, const Particle& particle);
+		/// <summary>Removes a particle in constant time, the last particle is moved in its place</summary>
+		/// <param name="index">The particle's index</param>
+		void remove(size_t index);
+		/// <summary>
+		/// Removes every particle whose lifetime ran out<para/>
+		/// Expired particles are swapped with the last living ones, the order of the particles isn't preserved
+		/// </summary>
+		/// <returns>The amount of particles removed</returns>
+		size_t removeExpired();
+		/// <summary>Removes every particle</summary>
+		void clear();
+		/// <summary>Reserves memory for an amount of particles</summary>
+		/// <param name="capacity">The amount of particles</param>
+		void reserve(size_t capacity);
+		/// <summary>Gathers the attributes of a particle</summary>
+		/// <param name="index">The particle's index</param>
+		/// <returns>The particle</returns>
+		/// <see cref="set"/>
+		Particle get(size_t index) const;
+		/// <summary>Scatters the attributes of a particle, its initial lifetime is kept</summary>
+		/// <param name="index">The particle's index</param>
+		/// <param name="particle">The particle's new attributes</param>
+		/// <see cref="get"/>
+		void set(size_t index, const Particle& particle);
+		/// <summary>Returns a range of particles</summary>
+		/// <param name="first">The range's first particle</param>
+		/// <param name="count">The amount of particles in the range</param>
+		/// <returns>The range</returns>
+		ParticleSpan getSpan(size_t first, size_t count);
+		/// <summary>Returns every particle as a single range</summary>
+		/// <returns>The range</returns>
+		inline ParticleSpan getSpan() { return getSpan(0, size()); }
+		/// <summary>
+		/// Calls a kernel for consecutive spans of ChunkSize particles, concurrently if a task pool is provided<para/>
+		/// The chunks don't depend on the pool's amount of threads, a kernel only processing the particles of<para/>
+		/// its span gives the same results whether it's called concurrently or not
+		/// </summary>
+		/// <param name="pool">The task pool, nullptr to call the kernel on the calling thread</param>
+		/// <param name="kernel">Callable taking a ParticleSpan and the index of its first particle</param>
+		template <typename Kernel>
+		void forEachChunk(TaskPool* pool, Kernel kernel);
+		/// <summary>Returns the amount of particles stored</summary>
+		/// <returns>The amount of particles</returns>
+		inline size_t size() const { return lifetime_.size(); }
+		/// <summary>Checks if no particles are stored</summary>
+		/// <returns>True if the storage is empty, false otherwise</returns>
+		inline bool empty() const { return lifetime_.empty(); }
+
+		/// <summary>Gathers the attributes of a particle of a span</summary>
+		/// <param name="span">The particles</param>
+		/// <param name="index">The particle's index within the span</param>
+		/// <returns>The particle</returns>
+		static Particle gather(const ParticleSpan& span, size_t index);
+		/// <summary>Scatters the attributes of a particle of a span, its initial lifetime is kept</summary>
+		/// <param name="span">The particles</param>
+		/// <param name="index">The particle's index within the span</param>
+		/// <param name="particle">The particle's new attributes</param>
+		static void scatter(const ParticleSpan& span, size_t index, const Particle& particle);
+		/// <summary>Applies the particles' acceleration to their velocity and their velocity to their position</summary>
+		/// <param name="span">The particles</param>
+		/// <param name="dt">Time passed in current frame (in seconds)</param>
+		static void integrate(const ParticleSpan& span, float dt);
+		/// <summary>Reduces the particles' remaining lifetime</summary>
+		/// <param name="span">The particles</param>
+		/// <param name="dt">Time passed in current frame (in seconds)</param>
+		static void age(const ParticleSpan& span, float dt);
+		/// <summary>Computes the particles' fade ratios from their remaining and initial lifetimes</summary>
+		/// <param name="span">The particles</param>
+		static void computeFade(const ParticleSpan& span);
+		/// <summary>
+		/// Writes the positions and colors of the particles' quads, four vertices per particle<para/>
+		/// The vertices' texture coordinates are left untouched
+		/// </summary>
+		/// <param name="span">The particles</param>
+		/// <param name="vertices">The first vertex of the span's first particle</param>
+		/// <param name="fade">True to multiply the particles' alpha by their fade ratio, false otherwise</param>
+		static void computeQuads(const ParticleSpan& span, sf::Vertex* vertices, bool fade);
+		/// <summary>Computes the bounding rectangle of the particles' quads</summary>
+		/// <param name="span">The particles</param>
+		/// <returns>The bounding rectangle, empty if the span is empty</returns>
+		static sf::FloatRect computeBounds(const ParticleSpan& span);
+		/// <summary>Returns the instruction set the kernels were compiled for</summary>
+		/// <returns>"AVX", "SSE2" or "Scalar"</returns>
+		static const char* getInstructionSet();
+
+	private:
+		std::vector<float>      position_x_;
+		std::vector<float>      position_y_;
+		std::vector<float>      velocity_x_;
+		std::vector<float>      velocity_y_;
+		std::vector<float>      acceleration_x_;
+		std::vector<float>      acceleration_y_;
+		std::vector<float>      size_x_;
+		std::vector<float>      size_y_;
+		std::vector<sf::Color>  color_;
+		std::vector<float>      lifetime_;
+		std::vector<float>      inverse_lifetime_;
+		std::vector<float>      fade_;
+		std::vector<sf::Uint32> tag_;
+	};
+}
+#include "ParticleStorage.inl"
+#endif
@@ -0,0 +1,20 @@
+namespace au
+{
+	template <typename Kernel>
+	void ParticleStorage::forEachChunk(TaskPool* pool, Kernel kernel)
+	{
+		const size_t count = size();
+		if (!pool || count <= ChunkSize) {
+			for (size_t first = 0; first < count; first += ChunkSize)
+				kernel(getSpan(first, std::min(ChunkSize, count - first)), first);
+			return;
+		}
+
+		TaskPool::Group group;
+		for (size_t first = 0; first < count; first += ChunkSize) {
+			const ParticleSpan span(getSpan(first, std::min(ChunkSize, count - first)));
+			pool->submit(group, [span, first, &kernel]() { kernel(span, first); });
+		}
+		pool->wait(group);
+	}
+}
@@ -1,114 +1,411 @@
-#include <iostream>
+#include <algorithm>
 
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <SFML/System/Clock.hpp>
 
 #include "ParticleSystem.h"
+#include "RenderQueue.h"
 
 namespace au
 {
+	namespace
+	{
+		sf::FloatRect combine(const sf::FloatRect& lhs, const sf::FloatRect& rhs)
+		{
+			const float left = std::min(lhs.left, rhs.left);
+			const float top = std::min(lhs.top, rhs.top);
+			const float right = std::max(lhs.left + lhs.width, rhs.left + rhs.width);
+			const float bottom = std::max(lhs.top + lhs.height, rhs.top + rhs.height);
+			return sf::FloatRect(left, top, right - left, bottom - top);
+		}
+	}
+
 	ParticleSystem::ParticleSystem(sf::PrimitiveType prim_type, size_t max_particles,
 		const sf::Texture* texture)
 		: max_particles_(max_particles)
-		, vertex_array_(prim_type)
+		, vertices_()
+		, vertex_count_(0)
+		, primitive_type_(prim_type)
+		, textured_quads_(0)
+		, texture_size_()
 		, texture_(texture)
 		, emitter_active_(false)
 		, emitter_pos_()
-		, original_particle_lifetime_(sf::Time::Zero)
+		, integration_active_(false)
+		, fade_active_(true)
+		, emission_rate_(0.f)
+		, emission_accumulator_(0.f)
+		, parallel_simulation_(false)
+		, simulation_group_()
+		, simulation_budgeted_(false)
+		, priority_(ParticleBudget::Priority::Normal)
+		, detail_scale_(1.f)
+		, full_detail_particles_(0)
+		, shed_accumulator_(0.f)
+		, shed_particles_(0)
+		, capped_particles_(0)
+		, culled_(false)
+		, bounds_active_(false)
+		, visible_(true)
+		, bounds_()
+		, chunk_bounds_()
+		, collision_grid_(nullptr)
+		, collision_response_(CollisionResponse::Bounce)
+		, restitution_(0.5f)
 		, initializer_(nullptr)
 		, affector_(nullptr)
+		, span_affector_(nullptr)
 	{
+		setEventSubscriptions({});
+		reserveParticles();
 	}
 
 	ParticleSystem::ParticleSystem(const ParticleSystem& copy)
-		: max_particles_(copy.max_particles_)
-		, vertex_array_(copy.vertex_array_)
+		: particles_((copy.synchronize(), copy.particles_))
+		, max_particles_(copy.max_particles_)
+		, vertices_(copy.vertices_)
+		, vertex_count_(copy.vertex_count_)
+		, primitive_type_(copy.primitive_type_)
+		, textured_quads_(copy.textured_quads_)
+		, texture_size_(copy.texture_size_)
 		, texture_(copy.texture_)
 		, emitter_active_(copy.emitter_active_)
 		, emitter_pos_(copy.emitter_pos_)
-		, original_particle_lifetime_(copy.original_particle_lifetime_)
+		, integration_active_(copy.integration_active_)
+		, fade_active_(copy.fade_active_)
+		, emission_rate_(copy.emission_rate_)
+		, emission_accumulator_(copy.emission_accumulator_)
+		, parallel_simulation_(copy.parallel_simulation_)
+		, simulation_group_()
+		, simulation_budgeted_(false)
+		, priority_(copy.priority_)
+		, detail_scale_(copy.detail_scale_)
+		, full_detail_particles_(copy.full_detail_particles_)
+		, shed_accumulator_(copy.shed_accumulator_)
+		, shed_particles_(copy.shed_particles_)
+		, capped_particles_(copy.capped_particles_)
+		, culled_(copy.culled_)
+		, bounds_active_(copy.bounds_active_)
+		, visible_(copy.visible_)
+		, bounds_(copy.bounds_)
+		, chunk_bounds_(copy.chunk_bounds_)
+		, collision_grid_(copy.collision_grid_)
+		, collision_response_(copy.collision_response_)
+		, restitution_(copy.restitution_)
 		, initializer_(copy.initializer_ ? std::make_unique<std::function<Particle()>>(*copy.initializer_) : nullptr)
 		, affector_(copy.affector_ ? std::make_unique<std::function<void(Particle&, sf::Time)>>(*copy.affector_) : nullptr)
+		, span_affector_(copy.span_affector_ ? std::make_unique<std::function<void(const ParticleSpan&, sf::Time)>>(*copy.span_affector_) : nullptr)
 	{
+		if (collision_grid_)
+			collision_grid_->addParticleSystem(*this);
+	}
+
+	ParticleSystem::~ParticleSystem()
+	{
+		synchronize();
 	}
 
 	void ParticleSystem::setInitializer(const std::function<Particle()>& initializer)
 	{
+		synchronize();
 		initializer_ = std::make_unique<std::function<Particle()>>(std::move(initializer));
-		original_particle_lifetime_ = (*initializer_)().lifetime;
 	}
 
 	void ParticleSystem::setAffector(const std::function<void(Particle&, sf::Time)>& affector)
 	{
+		synchronize();
 		affector_ = std::make_unique<std::function<void(Particle&, sf::Time)>>(std::move(affector));
 	}
 
-	void ParticleSystem::computeVertices() const
+	void ParticleSystem::setSpanAffector(const std::function<void(const ParticleSpan&, sf::Time)>& affector)
 	{
-		if (original_particle_lifetime_ != sf::Time::Zero && !particles_.empty())
-		{
-			sf::Vector2f size(particles_.front().size);
-			sf::Vector2f half = size / 2.f;
-
-			vertex_array_.clear();
-
-			for (const Particle& particle : particles_)
-			{
-				sf::Vector2f pos = particle.position;
-				sf::Color c = particle.color;
-				float ratio = particle.lifetime.asSeconds() / original_particle_lifetime_.asSeconds();
-				c.a = static_cast<sf::Uint8>(255 * std::max(ratio, 0.f));
-
-				sf::Vector2u textureSize(texture_ ? texture_->getSize() : sf::Vector2u(0, 0));
-				addVertex(pos.x - half.x, pos.y - half.y, 0, 0, c);
-				addVertex(pos.x + half.x, pos.y - half.y, textureSize.x, 0, c);
-				addVertex(pos.x + half.x, pos.y + half.y, textureSize.x, textureSize.y, c);
-				addVertex(pos.x - half.x, pos.y + half.y, 0, textureSize.y, c);
-			}
+		synchronize();
+		span_affector_ = std::make_unique<std::function<void(const ParticleSpan&, sf::Time)>>(affector);
+	}
+
+	void ParticleSystem::setEmissionRate(float rate)
+	{
+		synchronize();
+		emission_rate_ = std::max(rate, 0.f);
+		emission_accumulator_ = 0.f;
+	}
+
+	size_t ParticleSystem::emitBurst(size_t count)
+	{
+		synchronize();
+		const size_t emitted = emitParticles(count);
+		computeVertices();
+		return emitted;
+	}
+
+	void ParticleSystem::prewarm(sf::Time duration, sf::Time time_step)
+	{
+		synchronize();
+		if (time_step <= sf::Time::Zero)
+			return;
+
+		for (sf::Time elapsed = sf::Time::Zero; elapsed < duration; elapsed += time_step)
+			simulate(std::min(time_step, duration - elapsed));
+		computeVertices();
+	}
+
+	void ParticleSystem::setMaxParticles(size_t max)
+	{
+		synchronize();
+		max_particles_ = max;
+		reserveParticles();
+	}
+
+	void ParticleSystem::activateParallelSimulation(bool flag)
+	{
+		synchronize();
+		parallel_simulation_ = flag;
+	}
+
+	void ParticleSystem::synchronize() const
+	{
+		TaskPool::getDefault().wait(simulation_group_);
+		if (simulation_budgeted_.exchange(false))
+			ParticleBudget::getDefault().removeSimulation(simulation_group_);
+	}
+
+	void ParticleSystem::setPriority(ParticleBudget::Priority priority)
+	{
+		synchronize();
+		priority_ = priority;
+	}
+
+	void ParticleSystem::setCollisionGrid(const ParticleCollisionGrid* grid, CollisionResponse response, float restitution)
+	{
+		synchronize();
+		if (collision_grid_ != grid) {
+			if (collision_grid_)
+				collision_grid_->removeParticleSystem(*this);
+			if (grid)
+				grid->addParticleSystem(*this);
 		}
-		else
-			std::cout << "\n\nA particle's lifetime can't be set at 0\n\n";
+		collision_grid_ = grid;
+		collision_response_ = response;
+		restitution_ = restitution;
 	}
 
-	void ParticleSystem::addParticle()
+	void ParticleSystem::reserveParticles()
 	{
-		particles_.push_back(std::move((*initializer_)()));
-		particles_.back().position = emitter_pos_;
-		particles_.back().originalLifetime = &original_particle_lifetime_;
+		particles_.reserve(max_particles_);
+		vertices_.reserve(max_particles_ * 4);
 	}
 
-	void ParticleSystem::addVertex(float x, float y, unsigned tu, unsigned tv, const sf::Color& color) const
+	void ParticleSystem::setTexture(const sf::Texture* texture)
 	{
-		vertex_array_.append(sf::Vertex(sf::Vector2f(x, y), color, sf::Vector2f((float)tu, (float)tv)));
+		synchronize();
+		texture_ = texture;
+		computeVertices();
 	}
 
-	void ParticleSystem::updateCurrent(sf::Time dt)
+	void ParticleSystem::computeVertices()
 	{
-		if (emitter_active_ && initializer_ && affector_)
-		{
-			if (particles_.size() < max_particles_ || max_particles_ == 0)
-				addParticle();
+		const size_t count = particles_.size();
+		vertex_count_ = count * 4;
+		if (vertices_.size() < vertex_count_)
+			vertices_.resize(vertex_count_);
+
+		const sf::Vector2u texture_size(texture_ ? texture_->getSize() : sf::Vector2u(0, 0));
+		if (texture_size != texture_size_) {
+			texture_size_ = texture_size;
+			textured_quads_ = 0;
+		}
+
+		// Every quad uses the whole texture, the coordinates of the quads already written remain valid
+		const sf::Vector2f size(static_cast<sf::Vector2f>(texture_size_));
+		for (size_t quad = textured_quads_ * 4; quad < vertex_count_; quad += 4) {
+			vertices_[quad].texCoords = sf::Vector2f(0.f, 0.f);
+			vertices_[quad + 1].texCoords = sf::Vector2f(size.x, 0.f);
+			vertices_[quad + 2].texCoords = sf::Vector2f(size.x, size.y);
+			vertices_[quad + 3].texCoords = sf::Vector2f(0.f, size.y);
+		}
+		textured_quads_ = std::max(textured_quads_, count);
+
+		chunk_bounds_.resize(bounds_active_ ? (count + ParticleStorage::ChunkSize - 1) / ParticleStorage::ChunkSize : 0);
+		particles_.forEachChunk(getSimulationPool(), [this](const ParticleSpan& span, size_t first) {
+			if (fade_active_)
+				ParticleStorage::computeFade(span);
+			ParticleStorage::computeQuads(span, vertices_.data() + first * 4, fade_active_);
+			if (bounds_active_)
+				chunk_bounds_[first / ParticleStorage::ChunkSize] = ParticleStorage::computeBounds(span);
+		});
+		mergeBounds();
+	}
 
-			for (auto& particle : particles_) {
+	void ParticleSystem::mergeBounds()
+	{
+		// Chunks are merged in order, the bounds don't depend on the amount of threads
+		bounds_ = chunk_bounds_.empty() ? sf::FloatRect() : chunk_bounds_.front();
+		for (size_t i = 1; i < chunk_bounds_.size(); ++i)
+			bounds_ = combine(bounds_, chunk_bounds_[i]);
+	}
+
+	bool ParticleSystem::isVisible(const sf::View& view, const sf::Transform& transform) const
+	{
+		const sf::FloatRect view_rect(view.getInverseTransform().transformRect(sf::FloatRect(-1.f, -1.f, 2.f, 2.f)));
+		if (view_rect.contains(transform.transformPoint(emitter_pos_)))
+			return true;
+		return !particles_.empty() && view_rect.intersects(transform.transformRect(bounds_));
+	}
+
+	void ParticleSystem::initializeParticles(ParticleStorage& particles, size_t first, size_t count)
+	{
+		if (!initializer_)
+			return;
+
+		for (size_t i = first; i < first + count; ++i) {
+			Particle particle((*initializer_)());
+			particle.position = emitter_pos_;
+			particles.initialize(i, particle);
+		}
+	}
+
+	void ParticleSystem::affectParticles(const ParticleSpan& span, sf::Time dt)
+	{
+		if (span_affector_)
+			(*span_affector_)(span, dt);
+		if (affector_)
+			for (size_t i = 0; i < span.count; ++i) {
+				Particle particle(ParticleStorage::gather(span, i));
 				(*affector_)(particle, dt);
-				particle.lifetime -= dt;
+				ParticleStorage::scatter(span, i, particle);
 			}
-			if (!particles_.empty() && particles_.front().lifetime <= sf::Time::Zero) {
-				particles_.erase(particles_.begin());
+	}
+
+	size_t ParticleSystem::emitParticles(size_t count)
+	{
+		if (max_particles_ != 0)
+			count = std::min(count, max_particles_ - std::min(particles_.size(), max_particles_));
+
+		// The max particles are scaled by the budget's detail level
+		const size_t scaled_max = ParticleBudget::scaleMaxParticles(max_particles_, full_detail_particles_, detail_scale_);
+		if (scaled_max != 0) {
+			const size_t scaled_allowed = scaled_max - std::min(particles_.size(), scaled_max);
+			if (count > scaled_allowed) {
+				capped_particles_ += count - scaled_allowed;
+				count = scaled_allowed;
 			}
+		}
+		// Particles left uninitialized have no lifetime and are removed by the next update
+		if (count > 0)
+			initializeParticles(particles_, particles_.append(count), count);
+		if (detail_scale_ >= 1.f)
+			full_detail_particles_ = particles_.size();
+		return count;
+	}
+
+	void ParticleSystem::shedParticles(float count)
+	{
+		shed_accumulator_ += count;
+		const size_t shed = static_cast<size_t>(shed_accumulator_);
+		shed_accumulator_ -= static_cast<float>(shed);
+		shed_particles_ += shed;
+	}
+
+	void ParticleSystem::simulate(sf::Time dt)
+	{
+		if (emitter_active_) {
+			// Without emission rate one particle is emitted per update, both are scaled by the budget's detail level
+			const float emitted = emission_rate_ > 0.f ? emission_rate_ * dt.asSeconds() : 1.f;
+			emission_accumulator_ += emitted * detail_scale_;
+			const size_t count = static_cast<size_t>(emission_accumulator_);
+			emission_accumulator_ -= static_cast<float>(count);
+			shedParticles(emitted * (1.f - detail_scale_));
+			emitParticles(count);
+		}
+
+		const float seconds = dt.asSeconds();
+		particles_.forEachChunk(getSimulationPool(), [this, dt, seconds](const ParticleSpan& span, size_t) {
+			affectParticles(span, dt);
+			if (integration_active_)
+				ParticleStorage::integrate(span, seconds);
+			if (collision_grid_)
+				collision_grid_->collide(span, seconds, collision_response_, restitution_);
+			ParticleStorage::age(span, seconds);
+		});
+		particles_.removeExpired();
+	}
+
+	void ParticleSystem::simulateCulled(sf::Time dt)
+	{
+		const float seconds = dt.asSeconds();
+		if (emitter_active_)
+			shedParticles(emission_rate_ > 0.f ? emission_rate_ * seconds : 1.f);
 
+		chunk_bounds_.resize((particles_.size() + ParticleStorage::ChunkSize - 1) / ParticleStorage::ChunkSize);
+		particles_.forEachChunk(getSimulationPool(), [this, seconds](const ParticleSpan& span, size_t first) {
+			if (integration_active_)
+				ParticleStorage::integrate(span, seconds);
+			if (collision_grid_)
+				collision_grid_->collide(span, seconds, collision_response_, restitution_);
+			ParticleStorage::age(span, seconds);
+			chunk_bounds_[first / ParticleStorage::ChunkSize] = ParticleStorage::computeBounds(span);
+		});
+		mergeBounds();
+		particles_.removeExpired();
+	}
+
+	void ParticleSystem::step(sf::Time dt)
+	{
+		sf::Clock clock;
+		if (culled_)
+			simulateCulled(dt);
+		else {
+			simulate(dt);
 			computeVertices();
 		}
+
+		ParticleBudget& budget = ParticleBudget::getDefault();
+		budget.reportCost(clock.getElapsedTime());
+		budget.reportShedding(shed_particles_, capped_particles_, culled_);
+		shed_particles_ = 0;
+		capped_particles_ = 0;
+	}
+
+	void ParticleSystem::updateCurrent(sf::Time dt)
+	{
+		synchronize();
+
+		// The detail level is read before the simulation starts, it may run concurrently with other systems
+		const ParticleBudget& budget = ParticleBudget::getDefault();
+		bounds_active_ = budget.isActive();
+		detail_scale_ = budget.getScale(priority_);
+		culled_ = budget.isCulling(priority_) && !visible_;
+
+		if (parallel_simulation_) {
+			// The simulation may outlast the frame if the system isn't drawn
+			if (bounds_active_ && !simulation_budgeted_.exchange(true))
+				ParticleBudget::getDefault().addSimulation(simulation_group_);
+			TaskPool::getDefault().submit(simulation_group_, [this, dt]() { step(dt); });
+		}
 		else
-			std::cout << "\n\nUnable to update ParticleSystem\n"
-				      << "3 possible causes:\n"
-				      << "  - The Emitter hasn't been activated\n"
-				      << "  - The Initializer hasn't been set\n"
-				      << "  - The Affector hasn't been set\n\n";
+			step(dt);
 	}
 
 	void ParticleSystem::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
 	{
-		states.texture = texture_;
-		target.draw(vertex_array_, states);
+		synchronize();
+		if (bounds_active_)
+			visible_ = isVisible(target.getView(), states.transform);
+		if (!culled_ && vertex_count_ > 0) {
+			states.texture = texture_;
+			target.draw(vertices_.data(), vertex_count_, primitive_type_, states);
+		}
+	}
+
+	void ParticleSystem::enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		synchronize();
+		if (bounds_active_ && queue.getView())
+			visible_ = isVisible(*queue.getView(), states.transform);
+		if (!culled_ && vertex_count_ > 0) {
+			states.texture = texture_;
+			queue.submit(vertices_.data(), vertex_count_, primitive_type_, states, layer);
+		}
 	}
 }
\ No newline at end of file
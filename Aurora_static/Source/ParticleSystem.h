@@ -1,28 +1,24 @@
 #ifndef Aurora_ParticleSystem_H_
 #define Aurora_ParticleSystem_H_
 
+#include <atomic>
 #include <functional>
 
 #include <SFML/Graphics/Texture.hpp>
-#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/Vertex.hpp>
 
+#include "ParticleBudget.h"
+#include "ParticleCollisionGrid.h"
+#include "ParticleStorage.h"
 #include "SceneNode.h"
 
 namespace au
 {
-	/// <summary>Struct that describes a particle</summary>
-	struct Particle
-	{
-		sf::Vector2f position;
-		sf::Vector2f size;
-		sf::Vector2f velocity;
-		sf::Vector2f acceleration;
-		sf::Color	 color;
-		sf::Time	 lifetime;
-		sf::Time*    originalLifetime;
-	};
-
-	/// <summary>Class that manages particle creation and emission</summary>
+	/// <summary>
+	/// Class that manages particle creation and emission<para/>
+	/// Particles are kept in a structure-of-arrays ParticleStorage and processed by its vectorized kernels<para/>
+	/// The cost of every update is reported to the default ParticleBudget, which degrades the system under pressure
+	/// </summary>
 	class ParticleSystem : public SceneNode
 	{
 	public:
@@ -35,65 +31,223 @@ namespace au
 		/// <summary>Copy constructor</summary>
 		/// <param name="copy">The particle system that will be copied</param>
 		ParticleSystem(const ParticleSystem& copy);
+		/// <summary>Waits for the particles' simulation to finish</summary>
+		virtual ~ParticleSystem();
 	public:
 		/// <summary>Sets the particles' initializer</summary>
 		/// <param name="initializer">An std::function that returns a Particle</param>
 		void setInitializer(const std::function<Particle()>& initializer);
-		/// <summary>Sets the particles' affector</summary>
+		/// <summary>
+		/// Sets the particles' affector, called once per particle<para/>
+		/// Every particle is gathered from and scattered back to the storage, setSpanAffector is preferred
+		/// </summary>
 		/// <param name="affector">An std::function that takes in a particle and an sf::Time</param>
+		/// <see cref="setSpanAffector"/>
 		void setAffector(const std::function<void(Particle&, sf::Time)>& affector);
-		/// <summary>Sets the max particles that can be emitted</summary>
+		/// <summary>Sets the particles' span affector, called once per update with every chunk of particles</summary>
+		/// <param name="affector">An std::function that takes in a ParticleSpan and an sf::Time</param>
+		/// <see cref="setAffector"/>
+		void setSpanAffector(const std::function<void(const ParticleSpan&, sf::Time)>& affector);
+		/// <summary>
+		/// (De)Activates the built-in integration, the particles' acceleration is applied to their<para/>
+		/// velocity and their velocity to their position after the affectors were called
+		/// </summary>
+		/// <param name="flag">True to activate the integration, false otherwise</param>
+		inline void activateIntegration(bool flag = true) { synchronize(); integration_active_ = flag; }
+		/// <summary>
+		/// (De)Activates the built-in fade, the particles' alpha is multiplied by the ratio of their remaining lifetime<para/>
+		/// The particles' alpha is used as is while the fade is inactive
+		/// </summary>
+		/// <param name="flag">True to activate the fade, false otherwise</param>
+		inline void activateFade(bool flag = true) { synchronize(); fade_active_ = flag; }
+		/// <summary>Returns the amount of living particles</summary>
+		/// <returns>The amount of particles</returns>
+		inline size_t getParticleCount() const { synchronize(); return particles_.size(); }
+		/// <summary>Sets the max particles that can be emitted, memory is reserved for them</summary>
 		/// <param name="max">The max particles</param>
 		/// <see cref="getMaxParticles"/>
-		inline void setMaxParticles(size_t max = 0) { max_particles_ = max; }
+		void setMaxParticles(size_t max = 0);
 		/// <summary>Returns the max particles that can be emitted</summary>
 		/// <returns>The max particles</returns>
 		/// <see cref="setMaxParticles"/>
 		inline size_t getMaxParticles() const { return max_particles_; }
 		/// <summary>Sets the particles' texture</summary>
 		/// <param name="texture">The particles' texture</param>
-		inline void setTexture(const sf::Texture* texture) { texture_ = texture; }
-		/// <summary>(De)Activates the emitter</summary>
+		void setTexture(const sf::Texture* texture);
+		/// <summary>
+		/// (De)Activates the emitter's continuous emission<para/>
+		/// The particles already emitted keep being updated while the emitter is inactive
+		/// </summary>
 		/// <param name="flag">True to activate the emitter, false otherwise</param>
-		inline void activateEmitter(bool flag = true) { emitter_active_ = flag; }
+		inline void activateEmitter(bool flag = true) { synchronize(); emitter_active_ = flag; }
+		/// <summary>
+		/// Sets the amount of particles emitted per second, the fractions of particles are carried<para/>
+		/// over to the next updates so that the emission doesn't depend on the update frequency<para/>
+		/// At a rate of 0, one particle is emitted per update
+		/// </summary>
+		/// <param name="rate">The amount of particles per second</param>
+		/// <see cref="getEmissionRate"/>
+		void setEmissionRate(float rate);
+		/// <summary>Returns the amount of particles emitted per second</summary>
+		/// <returns>The amount of particles per second, 0 if one particle is emitted per update</returns>
+		/// <see cref="setEmissionRate"/>
+		inline float getEmissionRate() const { return emission_rate_; }
+		/// <summary>Emits particles at once, whether the emitter is active or not</summary>
+		/// <param name="count">The amount of particles, limited by the max particles</param>
+		/// <returns>The amount of particles emitted</returns>
+		size_t emitBurst(size_t count);
+		/// <summary>
+		/// Simulates the particle system for a duration in fixed time steps<para/>
+		/// Used after the system was set up so that it's shown in its steady state right away
+		/// </summary>
+		/// <param name="duration">The simulated duration</param>
+		/// <param name="time_step">The duration of a simulated update</param>
+		void prewarm(sf::Time duration, sf::Time time_step = sf::seconds(1.f / 60.f));
 		/// <summary>Sets the emitter's position</summary>
 		/// <param name="pos">The emitter's position</param>
-		inline void setEmitterPosition(sf::Vector2f pos) { emitter_pos_ = pos; }
+		inline void setEmitterPosition(sf::Vector2f pos) { synchronize(); emitter_pos_ = pos; }
 		/// <summary>Returns the emitter's position</summary>
 		/// <returns>The emitter's position</returns>
 		inline sf::Vector2f getEmitterPosition() const { return emitter_pos_; }
+		/// <summary>
+		/// (De)Activates the parallel simulation, the particles are then simulated on the default task pool<para/>
+		/// An update only starts the simulation, which runs concurrently with the rest of the frame until the<para/>
+		/// particles are drawn, queried or modified. The initializer is called from a worker thread and the<para/>
+		/// affectors concurrently from several, each with its own chunk of particles<para/>
+		/// Chunks don't depend on the amount of threads, the results are the same whether the simulation is parallel or not
+		/// </summary>
+		/// <param name="flag">True to activate the parallel simulation, false otherwise</param>
+		void activateParallelSimulation(bool flag = true);
+		/// <summary>Waits for the simulation started by the last update to finish, called before the particles are accessed</summary>
+		void synchronize() const;
+		/// <summary>
+		/// Sets how much of the system's detail is shed while the default particle budget is under pressure<para/>
+		/// Degraded systems emit fewer particles, are limited to fewer particles and are culled while off-screen,<para/>
+		/// unlimited systems are limited relative to their particle count at full detail<para/>
+		/// A culled system's particles keep being integrated and aged but aren't emitted, affected or drawn
+		/// </summary>
+		/// <param name="priority">The system's priority, Priority::Critical to never degrade the system</param>
+		/// <see cref="getPriority"/>
+		void setPriority(ParticleBudget::Priority priority);
+		/// <summary>Returns how much of the system's detail is shed while the default particle budget is under pressure</summary>
+		/// <returns>The system's priority</returns>
+		/// <see cref="setPriority"/>
+		inline ParticleBudget::Priority getPriority() const { return priority_; }
+		/// <summary>
+		/// Sets the grid of colliders the particles collide with after they were affected and integrated<para/>
+		/// The particles are expected to be expressed in the colliders' space (the system isn't transformed)
+		/// </summary>
+		/// <param name="grid">The collision grid, nullptr to deactivate the collisions</param>
+		/// <param name="response">How the particles react to the colliders</param>
+		/// <param name="restitution">The ratio of velocity kept by bouncing particles</param>
+		void setCollisionGrid(const ParticleCollisionGrid* grid, CollisionResponse response = CollisionResponse::Bounce,
+		                      float restitution = 0.5f);
+	protected:
+		/// <summary>
+		/// Initializes emitted particles, their position must be set to the emitter's position<para/>
+		/// The default implementation calls the initializer once per particle
+		/// </summary>
+		/// <param name="particles">The particle storage</param>
+		/// <param name="first">The index of the first emitted particle</param>
+		/// <param name="count">The amount of emitted particles</param>
+		virtual void initializeParticles(ParticleStorage& particles, size_t first, size_t count);
+		/// <summary>
+		/// Applies the affectors to a chunk of particles, called before the built-in integration<para/>
+		/// Chunks are affected concurrently while the parallel simulation is active<para/>
+		/// The default implementation calls the span affector and then the per-particle affector
+		/// </summary>
+		/// <param name="span">The chunk of particles</param>
+		/// <param name="dt">Time passed in current frame</param>
+		virtual void affectParticles(const ParticleSpan& span, sf::Time dt);
 	private:
-		/// <summary>Recomputes the vertices' positions and transparency ratios</summary>
-		void computeVertices() const;
-		/// <summary>Adds in a new particle</summary>
-		void addParticle();
-		/// <summary>Helper method to facilitate vertex insertion</summary>
-		/// <param name="x">The position along the x axis</param>
-		/// <param name="y">The position along the y axis</param>
-		/// <param name="tu">The texture rect position along the x axis</param>
-		/// <param name="tv">The texture rect position along the y axis</param>
-		/// <param name="color">The vertex's color</param>
-		void addVertex(float x, float y, unsigned tu, unsigned tv, const sf::Color& color) const;
-		/// <summary>Updates the particles (reduces particle lifetime, recomputes vertices)</summary>
+		/// <summary>Returns the task pool the chunks are processed on</summary>
+		/// <returns>The default task pool if the simulation is parallel, nullptr otherwise</returns>
+		inline TaskPool* getSimulationPool() const { return parallel_simulation_ ? &TaskPool::getDefault() : nullptr; }
+		/// <summary>Reserves the particles' and the vertices' memory for the max particles</summary>
+		void reserveParticles();
+		/// <summary>
+		/// Recomputes the particles' fade ratios and the vertices' positions and transparency in place, a chunk at a time<para/>
+		/// The vertex buffer only grows, texture coordinates are only written for new quads or once the texture changed
+		/// </summary>
+		void computeVertices();
+		/// <summary>Emits particles at the emitter's position, they're initialized in a single batch</summary>
+		/// <param name="count">The amount of particles, limited by the max particles</param>
+		/// <returns>The amount of particles emitted</returns>
+		size_t emitParticles(size_t count);
+		/// <summary>Merges the bounding rectangles computed per chunk into the particles' bounding rectangle</summary>
+		void mergeBounds();
+		/// <summary>Checks if the particles or the emitter are situated inside a view</summary>
+		/// <param name="view">The view</param>
+		/// <param name="transform">The system's transform</param>
+		/// <returns>True if the system is visible, false otherwise</returns>
+		bool isVisible(const sf::View& view, const sf::Transform& transform) const;
+		/// <summary>
+		/// Emits particles, affects, integrates and ages them a chunk at a time and removes the expired ones<para/>
+		/// Emission and removal are sequential so that the particles' order doesn't depend on the amount of threads
+		/// </summary>
+		/// <param name="dt">Time passed in current frame</param>
+		void simulate(sf::Time dt);
+		/// <summary>Integrates and ages the particles of a culled system without emitting, affecting or drawing them</summary>
+		/// <param name="dt">Time passed in current frame</param>
+		void simulateCulled(sf::Time dt);
+		/// <summary>Counts particles the emitter didn't emit, the fractions of particles are carried over</summary>
+		/// <param name="count">The amount of particles</param>
+		void shedParticles(float count);
+		/// <summary>Simulates the particles at the detail level of the default budget, then reports the update's cost to it</summary>
+		/// <param name="dt">Time passed in current frame</param>
+		void step(sf::Time dt);
+		/// <summary>Updates the particles (reduces particle lifetime, recomputes vertices), in the background if the simulation is parallel</summary>
 		/// <param name="dt">Time passed in current frame</param>
 		virtual void updateCurrent(sf::Time dt) override;
-		/// <summary>Draws all the vertices</summary>
+		/// <summary>Draws all the vertices, unless the system was culled</summary>
 		/// <param name="target">Render target (window, render texture)</param>
 		/// <param name="states">Render states (transform, texture)</param>
 		virtual void drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const override;
+		/// <summary>Submits all the vertices to the render queue, unless the system was culled</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The node's render layer</param>
+		virtual void enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const override;
 
 	private:
-		std::vector<Particle>                                     particles_;
+		ParticleStorage                                           particles_;
 		size_t								                      max_particles_;
-		mutable sf::VertexArray					                  vertex_array_;
+		std::vector<sf::Vertex>                                   vertices_;
+		size_t                                                    vertex_count_;
+		sf::PrimitiveType                                         primitive_type_;
+		size_t                                                    textured_quads_;
+		sf::Vector2u                                              texture_size_;
 		const sf::Texture*						                  texture_;
 
 		bool									                  emitter_active_;
 		sf::Vector2f                                              emitter_pos_;
+		bool                                                      integration_active_;
+		bool                                                      fade_active_;
+		float                                                     emission_rate_;
+		float                                                     emission_accumulator_;
+		bool                                                      parallel_simulation_;
+		mutable TaskPool::Group                                   simulation_group_;
+		mutable std::atomic<bool>                                 simulation_budgeted_;   // Registered to the default budget
+
+		ParticleBudget::Priority                                  priority_;
+		float                                                     detail_scale_;
+		size_t                                                    full_detail_particles_;
+		float                                                     shed_accumulator_;
+		size_t                                                    shed_particles_;
+		size_t                                                    capped_particles_;
+		bool                                                      culled_;
+		bool                                                      bounds_active_;
+		mutable bool                                              visible_;
+		sf::FloatRect                                             bounds_;
+		std::vector<sf::FloatRect>                                chunk_bounds_;
+
+		const ParticleCollisionGrid*                              collision_grid_;
+		CollisionResponse                                         collision_response_;
+		float                                                     restitution_;
 
-		sf::Time                                                  original_particle_lifetime_;
 		std::unique_ptr<std::function<Particle()>>                initializer_;
 		std::unique_ptr<std::function<void(Particle&, sf::Time)>> affector_;
+		std::unique_ptr<std::function<void(const ParticleSpan&, sf::Time)>> span_affector_;
 	};
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef Aurora_ParticleSystemT_H_
+#define Aurora_ParticleSystemT_H_
+
+#include <tuple>
+#include <utility>
+
+#include "ParticleAffectors.h"
+#include "ParticleSystem.h"
+
+namespace au
+{
+	/// <summary>
+	/// Particle system whose initializer and affectors are known at compile time<para/>
+	/// The affectors are plain function objects (see ParticleAffectors.h) called in order for every particle<para/>
+	/// within a single loop, the compiler can inline them instead of calling an std::function per particle<para/>
+	/// The std::function initializer and affectors of the ParticleSystem class are ignored<para/>
+	/// Example: ParticleSystemT&lt;SparkInitializer, affectors::Gravity, affectors::Drag, affectors::Integration&gt;
+	/// </summary>
+	template <typename Initializer, typename... Affectors>
+	class ParticleSystemT : public ParticleSystem
+	{
+	public:
+		/// <summary>Constructs the particle system</summary>
+		/// <param name="initializer">Function object returning a Particle</param>
+		/// <param name="affectors">The affectors, applied in order</param>
+		explicit ParticleSystemT(Initializer initializer = Initializer(), Affectors... affectors);
+		/// <summary>Waits for the simulation, which uses the initializer and the affectors, before they're destroyed</summary>
+		virtual ~ParticleSystemT();
+	public:
+		/// <summary>Returns the particles' initializer</summary>
+		/// <returns>The initializer</returns>
+		inline Initializer& getInitializer() { synchronize(); return initializer_; }
+		/// <summary>Returns one of the particles' affectors</summary>
+		/// <returns>The affector at index I</returns>
+		template <size_t I>
+		inline auto& getAffector() { synchronize(); return std::get<I>(affectors_); }
+	protected:
+		/// <summary>Initializes emitted particles with the initializer</summary>
+		/// <param name="particles">The particle storage</param>
+		/// <param name="first">The index of the first emitted particle</param>
+		/// <param name="count">The amount of emitted particles</param>
+		virtual void initializeParticles(ParticleStorage& particles, size_t first, size_t count) override;
+		/// <summary>Applies every affector to one particle of a chunk after the other</summary>
+		/// <param name="span">The chunk of particles</param>
+		/// <param name="dt">Time passed in current frame</param>
+		virtual void affectParticles(const ParticleSpan& span, sf::Time dt) override;
+	private:
+		/// <summary>Applies every affector to a particle</summary>
+		/// <param name="span">The particles</param>
+		/// <param name="i">The particle's index</param>
+		/// <param name="dt">Time passed in current frame (in seconds)</param>
+		template <size_t... I>
+		inline void affectParticle(const ParticleSpan& span, size_t i, float dt, std::index_sequence<I...>);
+
+	private:
+		Initializer              initializer_;
+		std::tuple<Affectors...> affectors_;
+	};
+
+	/// <summary>Creates a compile-time particle system, deducing the types of the initializer and the affectors</summary>
+	/// <param name="initializer">Function object returning a Particle (lambdas may be used)</param>
+	/// <param name="affectors">The affectors, applied in order</param>
+	/// <returns>The particle system</returns>
+	template <typename Initializer, typename... Affectors>
+	std::unique_ptr<ParticleSystemT<Initializer, Affectors...>> makeParticleSystem(Initializer initializer, Affectors... affectors);
+}
+#include "ParticleSystemT.inl"
+#endif
@@ -0,0 +1,52 @@
+namespace au
+{
+	template <typename Initializer, typename... Affectors>
+	ParticleSystemT<Initializer, Affectors...>::ParticleSystemT(Initializer initializer, Affectors... affectors)
+		: ParticleSystem()
+		, initializer_(std::move(initializer))
+		, affectors_(std::move(affectors)...)
+	{
+	}
+
+	template <typename Initializer, typename... Affectors>
+	ParticleSystemT<Initializer, Affectors...>::~ParticleSystemT()
+	{
+		synchronize();
+	}
+
+	template <typename Initializer, typename... Affectors>
+	void ParticleSystemT<Initializer, Affectors...>::initializeParticles(ParticleStorage& particles, size_t first, size_t count)
+	{
+		const sf::Vector2f emitter_pos(getEmitterPosition());
+		for (size_t i = first; i < first + count; ++i) {
+			Particle particle(initializer_());
+			particle.position = emitter_pos;
+			particles.initialize(i, particle);
+		}
+	}
+
+	template <typename Initializer, typename... Affectors>
+	void ParticleSystemT<Initializer, Affectors...>::affectParticles(const ParticleSpan& span, sf::Time dt)
+	{
+		const float seconds = dt.asSeconds();
+		for (size_t i = 0; i < span.count; ++i)
+			affectParticle(span, i, seconds, std::index_sequence_for<Affectors...>());
+	}
+
+	template <typename Initializer, typename... Affectors>
+	template <size_t... I>
+	void ParticleSystemT<Initializer, Affectors...>::affectParticle(const ParticleSpan& span, size_t i, float dt,
+	                                                               std::index_sequence<I...>)
+	{
+		// Expands to one call per affector in order, the parameters are unused without affectors
+		(void)span, (void)i, (void)dt;
+		using Expand = int[];
+		(void)Expand{ 0, (std::get<I>(affectors_)(span, i, dt), 0)... };
+	}
+
+	template <typename Initializer, typename... Affectors>
+	std::unique_ptr<ParticleSystemT<Initializer, Affectors...>> makeParticleSystem(Initializer initializer, Affectors... affectors)
+	{
+		return std::make_unique<ParticleSystemT<Initializer, Affectors...>>(std::move(initializer), std::move(affectors)...);
+	}
+}
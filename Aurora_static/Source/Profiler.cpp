@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <fstream>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#ifdef __GNUG__
+	#include <cxxabi.h>
+#endif
+
+#include "Profiler.h"
+
+namespace au
+{
+	namespace
+	{
+		// GCC and Clang return mangled type names
+		std::string getReadableName(const char* name)
+		{
+#ifdef __GNUG__
+			int status = 0;
+			char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+			if (status == 0 && demangled) {
+				std::string readable_name(demangled);
+				std::free(demangled);
+				return readable_name;
+			}
+#endif
+			return name;
+		}
+
+		// Type names may contain characters that must be escaped in JSON strings
+		void writeJsonString(std::ostream& stream, const std::string& string)
+		{
+			stream << '"';
+			for (char character : string) {
+				if (character == '"' || character == '\\')
+					stream << '\\';
+				if (static_cast<unsigned char>(character) >= 0x20)
+					stream << character;
+			}
+			stream << '"';
+		}
+
+		// Small thread indices are easier to read than hashed thread ids in the trace viewer
+		size_t getThreadIndex()
+		{
+			static std::atomic<size_t> thread_count(0);
+			thread_local const size_t thread_index = thread_count++;
+			return thread_index;
+		}
+	}
+
+	Profiler::Scope::Scope(const char* name, const char* category)
+		: name_(name)
+		, category_(category)
+		, start_(getInstance().getTimestamp())
+	{
+	}
+
+	Profiler::Scope::~Scope()
+	{
+		Profiler& profiler = getInstance();
+		profiler.record(name_, category_, start_, profiler.getTimestamp() - start_);
+	}
+
+	Profiler::Profiler()
+		: tracing_(false)
+		, max_trace_event_count_(1000000)
+		, dropped_trace_events_(0)
+	{
+	}
+
+	Profiler& Profiler::getInstance()
+	{
+		static Profiler profiler;
+		return profiler;
+	}
+
+	void Profiler::beginFrame()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		frame_entries_.clear();
+	}
+
+	void Profiler::endFrame()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		frame_summary_.clear();
+		for (const auto& entry : frame_entries_)
+			frame_summary_.push_back(entry.second);
+		std::sort(frame_summary_.begin(), frame_summary_.end(), [](const Entry& lhs, const Entry& rhs) {
+			return lhs.total_time > rhs.total_time;
+		});
+	}
+
+	void Profiler::record(const char* name, const char* category, sf::Int64 start, sf::Int64 duration)
+	{
+		// Concurrently updated subtrees are timed on the task pool's workers
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		Entry& entry = frame_entries_[EntryKey(name, category)];
+		entry.name = name;
+		entry.category = category;
+		entry.calls++;
+		entry.total_time += sf::microseconds(duration);
+
+		if (tracing_) {
+			if (trace_events_.size() < max_trace_event_count_) {
+				trace_events_.push_back({ name, category, start, duration, getThreadIndex() });
+			}
+			else
+				dropped_trace_events_++;
+		}
+	}
+
+	void Profiler::writeFrameSummary(std::ostream& stream) const
+	{
+		stream << std::left << std::setw(48) << "Name" << std::setw(20) << "Category"
+		       << std::right << std::setw(10) << "Calls" << std::setw(14) << "Total (ms)" << '\n';
+		for (const Entry& entry : frame_summary_)
+			stream << std::left << std::setw(48) << getReadableName(entry.name) << std::setw(20) << entry.category
+			       << std::right << std::setw(10) << entry.calls
+			       << std::setw(14) << std::fixed << std::setprecision(3) << entry.total_time.asMicroseconds() / 1000.0 << '\n';
+	}
+
+	void Profiler::activateTracing(bool flag)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		tracing_ = flag;
+	}
+
+	bool Profiler::writeChromeTrace(const std::string& filename)
+	{
+		std::ofstream file(filename);
+		if (!file)
+			return false;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		std::map<const char*, std::string> readable_names;
+		file << "{\"traceEvents\":[";
+		for (size_t i = 0; i < trace_events_.size(); ++i) {
+			const TraceEvent& event = trace_events_[i];
+			file << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+			auto readable_name = readable_names.find(event.name);
+			if (readable_name == readable_names.end())
+				readable_name = readable_names.emplace(event.name, getReadableName(event.name)).first;
+			writeJsonString(file, readable_name->second);
+			file << ",\"cat\":";
+			writeJsonString(file, event.category);
+			file << ",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.duration
+			     << ",\"pid\":0,\"tid\":" << event.thread << '}';
+		}
+		file << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << dropped_trace_events_ << "}}\n";
+
+		trace_events_.clear();
+		dropped_trace_events_ = 0;
+		return static_cast<bool>(file);
+	}
+}
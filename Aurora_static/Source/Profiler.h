@@ -0,0 +1,139 @@
+#ifndef Aurora_Profiler_H_
+#define Aurora_Profiler_H_
+
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/NonCopyable.hpp>
+
+#ifdef AURORA_PROFILING
+	#include <typeinfo>
+
+	#define AU_PROFILE_CONCATENATE_(lhs, rhs) lhs##rhs
+	#define AU_PROFILE_CONCATENATE(lhs, rhs) AU_PROFILE_CONCATENATE_(lhs, rhs)
+	/// <summary>Times the enclosing scope under a name and a category (string literals)</summary>
+	#define AU_PROFILE_SCOPE(name, category) \
+		const ::au::Profiler::Scope AU_PROFILE_CONCATENATE(au_profile_scope_, __LINE__)(name, category)
+	/// <summary>Times the enclosing scope under a node's dynamic type and a category</summary>
+	#define AU_PROFILE_NODE_SCOPE(node, category) AU_PROFILE_SCOPE(typeid(node).name(), category)
+	/// <summary>Marks the beginning of a frame</summary>
+	#define AU_PROFILE_BEGIN_FRAME() ::au::Profiler::getInstance().beginFrame()
+	/// <summary>Marks the end of a frame, the frame's summary is then available</summary>
+	#define AU_PROFILE_END_FRAME() ::au::Profiler::getInstance().endFrame()
+#else
+	#define AU_PROFILE_SCOPE(name, category)
+	#define AU_PROFILE_NODE_SCOPE(node, category)
+	#define AU_PROFILE_BEGIN_FRAME()
+	#define AU_PROFILE_END_FRAME()
+#endif
+
+namespace au
+{
+	/// <summary>
+	/// Collects the timings of the engine's hot paths when AURORA_PROFILING is defined<para/>
+	/// Scene nodes are timed per dynamic type, the handleEvent, update and draw categories cover<para/>
+	/// the node's whole subtree and the handleEventCurrent, updateCurrent and drawCurrent categories<para/>
+	/// only cover the node itself, the application and state stack phases are timed too<para/>
+	/// The timings are aggregated in a per-frame summary and can be recorded as Chrome trace events<para/>
+	/// (chrome://tracing), nothing is instrumented and the macros are empty if AURORA_PROFILING isn't defined
+	/// </summary>
+	class Profiler : private sf::NonCopyable
+	{
+	public:
+		/// <summary>Accumulated timings of a name and category over a frame</summary>
+		struct Entry
+		{
+			const char* name;
+			const char* category;
+			unsigned    calls;
+			sf::Time    total_time;
+		};
+		/// <summary>Times its lifetime and records it once destroyed</summary>
+		class Scope : private sf::NonCopyable
+		{
+		public:
+			/// <summary>Starts timing</summary>
+			/// <param name="name">The timed name (must outlive the profiler)</param>
+			/// <param name="category">The timed category (must outlive the profiler)</param>
+			Scope(const char* name, const char* category);
+			/// <summary>Stops timing and records the timing</summary>
+			~Scope();
+		private:
+			const char* name_;
+			const char* category_;
+			sf::Int64   start_;
+		};
+
+	public:
+		/// <summary>Returns the profiler shared by the engine</summary>
+		/// <returns>The profiler</returns>
+		static Profiler& getInstance();
+	public:
+		/// <summary>Starts aggregating the timings of a new frame</summary>
+		/// <see cref="endFrame"/>
+		void beginFrame();
+		/// <summary>Sorts the frame's timings by total time and stores them as the frame summary</summary>
+		/// <see cref="getFrameSummary"/>
+		void endFrame();
+		/// <summary>Records a timing</summary>
+		/// <param name="name">The timed name</param>
+		/// <param name="category">The timed category</param>
+		/// <param name="start">The start time in microseconds since the profiler's creation</param>
+		/// <param name="duration">The duration in microseconds</param>
+		void record(const char* name, const char* category, sf::Int64 start, sf::Int64 duration);
+		/// <summary>Returns the time elapsed since the profiler's creation</summary>
+		/// <returns>The elapsed time in microseconds</returns>
+		inline sf::Int64 getTimestamp() const { return clock_.getElapsedTime().asMicroseconds(); }
+		/// <summary>Returns the timings of the last ended frame, sorted by total time</summary>
+		/// <returns>The frame summary</returns>
+		/// <see cref="writeFrameSummary"/>
+		inline const std::vector<Entry>& getFrameSummary() const { return frame_summary_; }
+		/// <summary>Writes the last ended frame's summary as a table</summary>
+		/// <param name="stream">The output stream</param>
+		/// <see cref="getFrameSummary"/>
+		void writeFrameSummary(std::ostream& stream) const;
+		/// <summary>
+		/// (De)Activates recording every timing as a trace event<para/>
+		/// Deactivated by default
+		/// </summary>
+		/// <param name="flag">True to activate, false to deactivate</param>
+		/// <see cref="writeChromeTrace"/>
+		void activateTracing(bool flag);
+		/// <summary>Sets the maximum amount of trace events kept, the following ones are dropped</summary>
+		/// <param name="count">The maximum amount of trace events (one million by default)</param>
+		inline void setMaxTraceEventCount(size_t count) { max_trace_event_count_ = count; }
+		/// <summary>Writes the recorded trace events in the Chrome trace event format and clears them</summary>
+		/// <param name="filename">The JSON file's path</param>
+		/// <returns>True if the file was written, false otherwise</returns>
+		/// <see cref="activateTracing"/>
+		bool writeChromeTrace(const std::string& filename);
+	private:
+		/// <summary>Default constructor</summary>
+		Profiler();
+
+	private:
+		struct TraceEvent
+		{
+			const char* name;
+			const char* category;
+			sf::Int64   start;
+			sf::Int64   duration;
+			size_t      thread;
+		};
+		using EntryKey = std::pair<const char*, const char*>;
+
+		sf::Clock                 clock_;
+		std::map<EntryKey, Entry> frame_entries_;
+		std::vector<Entry>        frame_summary_;
+		std::vector<TraceEvent>   trace_events_;
+		bool                      tracing_;
+		size_t                    max_trace_event_count_;
+		size_t                    dropped_trace_events_;
+		std::mutex                mutex_;
+	};
+}
+#endif
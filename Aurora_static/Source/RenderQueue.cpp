@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+#include "RenderQueue.h"
+#include "SceneNode.h"
+
+namespace au
+{
+	namespace
+	{
+		// Packs the six blend mode enums into a sortable key
+		sf::Uint32 getBlendKey(const sf::BlendMode& blend_mode)
+		{
+			return static_cast<sf::Uint32>(blend_mode.colorSrcFactor)
+			     | static_cast<sf::Uint32>(blend_mode.colorDstFactor) << 4
+			     | static_cast<sf::Uint32>(blend_mode.colorEquation)  << 8
+			     | static_cast<sf::Uint32>(blend_mode.alphaSrcFactor) << 12
+			     | static_cast<sf::Uint32>(blend_mode.alphaDstFactor) << 16
+			     | static_cast<sf::Uint32>(blend_mode.alphaEquation)  << 20;
+		}
+	}
+
+	RenderQueue::RenderQueue()
+		: has_view_(false)
+	{
+	}
+
+	void RenderQueue::submit(const sf::Vertex* vertices, size_t vertex_count, sf::PrimitiveType type,
+	                         const sf::RenderStates& states, int layer)
+	{
+		if (vertex_count == 0)
+			return;
+
+		// Strips, fans and quads are converted to lists so that they can be appended to one another
+		const size_t first_vertex = vertices_.size();
+		const auto append = [this, vertices](size_t index) { vertices_.push_back(vertices[index]); };
+		sf::PrimitiveType batch_type = type;
+		switch (type) {
+		case sf::LineStrip:
+			batch_type = sf::Lines;
+			for (size_t i = 1; i < vertex_count; ++i) {
+				append(i - 1);
+				append(i);
+			}
+			break;
+		case sf::TriangleStrip:
+			batch_type = sf::Triangles;
+			for (size_t i = 2; i < vertex_count; ++i) {
+				append(i - 2);
+				append(i - 1);
+				append(i);
+			}
+			break;
+		case sf::TriangleFan:
+			batch_type = sf::Triangles;
+			for (size_t i = 2; i < vertex_count; ++i) {
+				append(0);
+				append(i - 1);
+				append(i);
+			}
+			break;
+		case sf::Quads:
+			batch_type = sf::Triangles;
+			for (size_t i = 3; i < vertex_count; i += 4) {
+				append(i - 3);
+				append(i - 2);
+				append(i - 1);
+				append(i - 3);
+				append(i - 1);
+				append(i);
+			}
+			break;
+		default:
+			vertices_.insert(vertices_.end(), vertices, vertices + vertex_count);
+		}
+
+		// Strips, fans and quads too short to form a primitive aren't drawn
+		if (vertices_.size() == first_vertex)
+			return;
+
+		for (size_t i = first_vertex; i < vertices_.size(); ++i)
+			vertices_[i].position = states.transform.transformPoint(vertices_[i].position);
+
+		Item item;
+		item.layer = layer;
+		item.blend_key = getBlendKey(states.blendMode);
+		item.primitive_type = batch_type;
+		item.states = states;
+		item.states.transform = sf::Transform::Identity;
+		item.node = nullptr;
+		item.first_vertex = first_vertex;
+		item.vertex_count = vertices_.size() - first_vertex;
+		items_.push_back(item);
+	}
+
+	void RenderQueue::submit(const SceneNode& node, const sf::RenderStates& states, int layer)
+	{
+		Item item;
+		item.layer = layer;
+		item.blend_key = getBlendKey(states.blendMode);
+		item.primitive_type = sf::Points;
+		item.states = states;
+		item.node = &node;
+		item.first_vertex = 0;
+		item.vertex_count = 0;
+		items_.push_back(item);
+	}
+
+	void RenderQueue::setView(const sf::View& view)
+	{
+		view_ = view;
+		has_view_ = true;
+	}
+
+	void RenderQueue::flush(sf::RenderTarget& target)
+	{
+		stats_ = Stats();
+		stats_.submitted_items = static_cast<unsigned>(items_.size());
+		stats_.batched_vertices = static_cast<unsigned>(vertices_.size());
+
+		// Sorting indices keeps the items' render states from being moved around
+		order_.resize(items_.size());
+		std::iota(order_.begin(), order_.end(), 0);
+		std::stable_sort(order_.begin(), order_.end(), [this](size_t lhs, size_t rhs) {
+			return compare(items_[lhs], items_[rhs]);
+		});
+
+		for (size_t i = 0; i < order_.size(); ) {
+			const Item& first = items_[order_[i]];
+			if (first.node) {
+				first.node->drawCurrent(target, first.states);
+				stats_.issued_draw_calls++;
+				++i;
+				continue;
+			}
+
+			size_t end = i + 1;
+			while (end < order_.size() && canMerge(first, items_[order_[end]]))
+				++end;
+
+			// A single item is drawn straight from the queue's vertices
+			if (end - i == 1)
+				target.draw(&vertices_[first.first_vertex], first.vertex_count, first.primitive_type, first.states);
+			else {
+				batch_.clear();
+				for (size_t j = i; j < end; ++j) {
+					const Item& item = items_[order_[j]];
+					batch_.insert(batch_.end(), vertices_.begin() + item.first_vertex,
+					              vertices_.begin() + item.first_vertex + item.vertex_count);
+				}
+				target.draw(batch_.data(), batch_.size(), first.primitive_type, first.states);
+			}
+			stats_.issued_draw_calls++;
+			i = end;
+		}
+
+		items_.clear();
+		vertices_.clear();
+	}
+
+	bool RenderQueue::compare(const Item& lhs, const Item& rhs)
+	{
+		if (lhs.layer != rhs.layer)
+			return lhs.layer < rhs.layer;
+
+		const auto lhs_shader = reinterpret_cast<std::uintptr_t>(lhs.states.shader);
+		const auto rhs_shader = reinterpret_cast<std::uintptr_t>(rhs.states.shader);
+		if (lhs_shader != rhs_shader)
+			return lhs_shader < rhs_shader;
+
+		const auto lhs_texture = reinterpret_cast<std::uintptr_t>(lhs.states.texture);
+		const auto rhs_texture = reinterpret_cast<std::uintptr_t>(rhs.states.texture);
+		if (lhs_texture != rhs_texture)
+			return lhs_texture < rhs_texture;
+
+		if (lhs.blend_key != rhs.blend_key)
+			return lhs.blend_key < rhs.blend_key;
+		return lhs.primitive_type < rhs.primitive_type;
+	}
+
+	bool RenderQueue::canMerge(const Item& lhs, const Item& rhs)
+	{
+		return !lhs.node && !rhs.node
+		    && lhs.layer == rhs.layer
+		    && lhs.states.shader == rhs.states.shader
+		    && lhs.states.texture == rhs.states.texture
+		    && lhs.blend_key == rhs.blend_key
+		    && lhs.primitive_type == rhs.primitive_type;
+	}
+}
@@ -0,0 +1,105 @@
+#ifndef Aurora_RenderQueue_H_
+#define Aurora_RenderQueue_H_
+
+#include <vector>
+
+#include <SFML/Graphics/RenderTarget.hpp>
+
+namespace au
+{
+	class SceneNode;
+
+	/// <summary>
+	/// Command buffer collecting the draw items of a scene before drawing them<para/>
+	/// Items are sorted by render layer and then by shader, texture and blend mode, items sharing<para/>
+	/// the same render states are merged into a single pre-transformed vertex array and drawn at once<para/>
+	/// Submission order is only preserved between items sharing the same render states of a layer,<para/>
+	/// render layers must be used to order overlapping items that use different render states<para/>
+	/// Filled through SceneNode::enqueue
+	/// </summary>
+	class RenderQueue : private sf::NonCopyable
+	{
+	public:
+		/// <summary>
+		/// Draw call statistics of the last flush<para/>
+		/// Every submitted item would've been a draw call without the render queue
+		/// </summary>
+		struct Stats
+		{
+			unsigned submitted_items   = 0;
+			unsigned issued_draw_calls = 0;
+			unsigned batched_vertices  = 0;
+		};
+
+	public:
+		/// <summary>Default constructor</summary>
+		RenderQueue();
+	public:
+		/// <summary>
+		/// Submits vertices that will be merged with the other items using the same render states<para/>
+		/// The vertices are copied and pre-transformed by the states' transform
+		/// </summary>
+		/// <param name="vertices">The vertices</param>
+		/// <param name="vertex_count">The amount of vertices</param>
+		/// <param name="type">The vertices' primitive type</param>
+		/// <param name="states">Render states (transform, texture, shader, blend mode)</param>
+		/// <param name="layer">The render layer</param>
+		void submit(const sf::Vertex* vertices, size_t vertex_count, sf::PrimitiveType type,
+		            const sf::RenderStates& states, int layer);
+		/// <summary>
+		/// Submits a node whose drawCurrent method is called when the queue is flushed<para/>
+		/// Used for nodes that can't provide their vertices, the item is never merged
+		/// </summary>
+		/// <param name="node">The node</param>
+		/// <param name="states">Render states (transform, texture, shader, blend mode)</param>
+		/// <param name="layer">The render layer</param>
+		void submit(const SceneNode& node, const sf::RenderStates& states, int layer);
+		/// <summary>Sorts, merges and draws all the submitted items, then empties the queue</summary>
+		/// <param name="target">Render target (window, render texture)</param>
+		void flush(sf::RenderTarget& target);
+		/// <summary>Returns the statistics of the last flush</summary>
+		/// <returns>The statistics</returns>
+		inline const Stats& getStats() const { return stats_; }
+		/// <summary>Sets the view used by the scene's culling layers to cull the submitted nodes</summary>
+		/// <param name="view">The view the items will be drawn with</param>
+		/// <see cref="getView"/>
+		/// <seealso cref="CullingLayer"/>
+		void setView(const sf::View& view);
+		/// <summary>Returns the view used to cull the submitted nodes</summary>
+		/// <returns>The view, nullptr if none was set</returns>
+		/// <see cref="setView"/>
+		inline const sf::View* getView() const { return has_view_ ? &view_ : nullptr; }
+	private:
+		struct Item
+		{
+			int                 layer;
+			sf::Uint32          blend_key;
+			sf::PrimitiveType   primitive_type;
+			sf::RenderStates    states;
+			const SceneNode*    node;
+			size_t              first_vertex;
+			size_t              vertex_count;
+		};
+
+		/// <summary>Checks if an item is drawn before another one</summary>
+		/// <param name="lhs">The first item</param>
+		/// <param name="rhs">The second item</param>
+		/// <returns>True if lhs is drawn before rhs</returns>
+		static bool compare(const Item& lhs, const Item& rhs);
+		/// <summary>Checks if two items can be drawn with a single draw call</summary>
+		/// <param name="lhs">The first item</param>
+		/// <param name="rhs">The second item</param>
+		/// <returns>True if they can be merged, false otherwise</returns>
+		static bool canMerge(const Item& lhs, const Item& rhs);
+
+	private:
+		std::vector<Item>       items_;
+		std::vector<size_t>     order_;
+		std::vector<sf::Vertex> vertices_;
+		std::vector<sf::Vertex> batch_;
+		Stats                   stats_;
+		sf::View                view_;
+		bool                    has_view_;
+	};
+}
+#endif
@@ -1,25 +1,82 @@
 #ifndef Aurora_ResourceHolder_H_
 #define Aurora_ResourceHolder_H_
 
+#include <atomic>
+#include <deque>
+#include <future>
 #include <map>
+#include <memory>
 
 #include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/Font.hpp>
 
+#include "TaskPool.h"
+
 namespace au
 {
+	/// <summary>
+	/// How a resource is loaded asynchronously: decoded on a worker thread, then finalized on the main thread<para/>
+	/// Resources are decoded straight into the holder's resource by default, nothing is left to finalize
+	/// </summary>
+	/// <param name="Res">SFML resource type</param>
+	template <typename Res>
+	struct AsyncLoadTraits
+	{
+		struct Decoded {};
+
+		static bool decode(const std::string& filename, Decoded&, Res& res) { return res.loadFromFile(filename); }
+		static bool finalize(Decoded&, Res&) { return true; }
+	};
+
+	/// <summary>
+	/// Textures are decoded into images, only their upload to the graphics card is left to the main thread<para/>
+	/// The holder's texture isn't touched by the worker thread
+	/// </summary>
+	template <>
+	struct AsyncLoadTraits<sf::Texture>
+	{
+		using Decoded = sf::Image;
+
+		static bool decode(const std::string& filename, Decoded& decoded, sf::Texture&) { return decoded.loadFromFile(filename); }
+		static bool finalize(Decoded& decoded, sf::Texture& res) { return res.loadFromImage(decoded); }
+	};
+
 	/// <summary>
 	/// Stores SFML resources by providing a filename and an ID(enum value)<para/>
 	/// Available typedefs: TextureHolder, ImageHolder, FontHolder and SoundBufferHolder<para/>
-	/// Only an ID has to be provided if one of the available typedefs is used
+	/// Only an ID has to be provided if one of the available typedefs is used<para/>
+	/// Resources loaded asynchronously are decoded on a task pool while the application keeps running, the work that<para/>
+	/// has to happen on the main thread is then done by finalizeAsyncLoads under a time budget each frame
 	/// </summary>
 	/// <param name="ID">Enumeration type</param>
 	/// <param name="Res">SFML resource type (sf::Texture, sf::Font, sf::Image, etc.)</param>
+	/// <example>
+	/// <code>
+	/// void LoadingState::setupResources()
+	/// {
+	///     textures_.loadAsync("Assets/Textures/Knight.png", Textures::Knight);
+	///     textures_.loadAsync("Assets/Textures/Castle.png", Textures::Castle);
+	/// }
+	///
+	/// bool LoadingState::update(sf::Time dt)
+	/// {
+	///     textures_.finalizeAsyncLoads(sf::milliseconds(4));
+	///     progress_bar_.setProgress(textures_.getAsyncLoadProgress());
+	///     ...
+	/// }
+	/// </code>
+	/// </example>
 	template <typename ID, typename Res>
 	class ResourceHolder : private sf::NonCopyable
 	{
+	public:
+		/// <summary>Default constructor</summary>
+		ResourceHolder();
+		/// <summary>Waits for the resources still being decoded, they're discarded</summary>
+		~ResourceHolder();
 	public:
 		/// <summary>Loads in a resource</summary>
 		/// <param name="filename">String containing the resource file path</param>
@@ -35,6 +92,42 @@ namespace au
 		/// <seealso cref="get"/>
 		template <typename T>
 		void load(const std::string& filename, const T& t, ID id);
+		/// <summary>
+		/// Starts loading a resource in the background, the resource is decoded on a task pool and only retrievable<para/>
+		/// once finalizeAsyncLoads finalized it, it can't be retrieved or unloaded before<para/>
+		/// Pools without worker threads leave the decoding to finalizeAsyncLoads, within its time budget
+		/// </summary>
+		/// <param name="filename">String containing the resource file path</param>
+		/// <param name="id">Enumeration value with which to link the resource, it mustn't be loaded or loading already</param>
+		/// <param name="pool">
+		/// The task pool decoding the resource, the same pool must be used until every asynchronous load is finalized<para/>
+		/// The pool must outlive the holder
+		/// </param>
+		/// <returns>Future set to true once the resource is retrievable, false if it failed to load or if the id is taken</returns>
+		/// <see cref="finalizeAsyncLoads"/>
+		/// <seealso cref="finishAsyncLoads"/>
+		std::shared_future<bool> loadAsync(const std::string& filename, ID id, TaskPool& pool = TaskPool::getDefault());
+		/// <summary>
+		/// Inserts the resources decoded in the background into the holder, finishing the work that must happen<para/>
+		/// on the main thread (uploading textures, etc.), until the time budget is spent<para/>
+		/// At least one decoded resource is finalized per call, to be called once per frame while loading
+		/// </summary>
+		/// <param name="budget">The time the call may spend</param>
+		/// <returns>The amount of resources finalized</returns>
+		/// <see cref="loadAsync"/>
+		size_t finalizeAsyncLoads(sf::Time budget);
+		/// <summary>Waits for every asynchronous load and finalizes them, the calling thread is blocked</summary>
+		/// <see cref="loadAsync"/>
+		void finishAsyncLoads();
+		/// <summary>Returns the ratio of asynchronous loads finalized since the holder last had none pending</summary>
+		/// <returns>The progress between 0 and 1, 1 if no load is pending</returns>
+		inline float getAsyncLoadProgress() const
+		{
+			return async_load_count_ > 0 ? static_cast<float>(finished_async_load_count_) / async_load_count_ : 1.f;
+		}
+		/// <summary>Returns the amount of asynchronous loads that weren't finalized yet</summary>
+		/// <returns>The amount of pending loads</returns>
+		inline size_t getPendingAsyncLoadCount() const { return async_loads_.size(); }
 		/// <summary>Unloads a resource</summary>
 		/// <param name="id">ID of the resource to unload</param>
 		/// <see cref="load"/>
@@ -50,13 +143,35 @@ namespace au
 		/// <see cref="load"/>
 		const Res& get(ID id) const;
 	private:
+		/// <summary>Resource loaded asynchronously, shared with the task decoding it</summary>
+		struct AsyncLoad
+		{
+			enum State { Queued, Decoded, Failed };
+
+			std::string                              filename;
+			ID                                       id;
+			Res*                                     res;         // The holder's resource, inserted when the load starts
+			typename AsyncLoadTraits<Res>::Decoded   decoded;
+			std::atomic<int>                         state;
+			bool                                     submitted;   // False if left to finalizeAsyncLoads
+			std::promise<bool>                       promise;
+		};
+
 		/// <summary>Insert resource into holder</summary>
 		/// <param name="res">Resource to be added</param>
 		/// <param name="id">Associated ID</param>
 		void insertResource(const Res& res, ID id);
+		/// <summary>Decodes an asynchronously loaded resource, may be called by any thread</summary>
+		/// <param name="load">The load</param>
+		static void decode(AsyncLoad& load);
 
 	private:
-		std::map<ID, Res> resource_map_;
+		std::map<ID, Res>                       resource_map_;
+		std::deque<std::shared_ptr<AsyncLoad>>  async_loads_;
+		TaskPool*                               async_pool_;   // Null once every asynchronous load is finalized
+		TaskPool::Group                         async_group_;
+		size_t                                  async_load_count_;
+		size_t                                  finished_async_load_count_;
 	};
 
 	template <typename ID>
@@ -1,8 +1,33 @@
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <tuple>
+
+#include <SFML/System/Clock.hpp>
 
 namespace au
 {
+	/// <summary>Default constructor</summary>
+	template <typename ID, typename Res>
+	ResourceHolder<ID, Res>::ResourceHolder()
+		: resource_map_()
+		, async_loads_()
+		, async_pool_(nullptr)
+		, async_group_()
+		, async_load_count_(0)
+		, finished_async_load_count_(0)
+	{
+	}
+
+	/// <summary>Waits for the resources still being decoded, they're discarded</summary>
+	template <typename ID, typename Res>
+	ResourceHolder<ID, Res>::~ResourceHolder()
+	{
+		// The tasks reference the loads, not the holder, but they must be done before the pool's group is destroyed
+		if (async_pool_)
+			async_pool_->wait(async_group_);
+	}
+
 	/// <summary>Loads in a resource</summary>
 	/// <param name="filename">String containing the resource file path</param>
 	/// <param name="id">Enumeration value with which to link the resource</param>
@@ -35,6 +60,111 @@ namespace au
 			insertResource(std::move(res), id);
 	}
 
+	/// <summary>
+	/// Starts loading a resource in the background, the resource is decoded on a task pool and only retrievable<para/>
+	/// once finalizeAsyncLoads finalized it, it can't be retrieved or unloaded before<para/>
+	/// Pools without worker threads leave the decoding to finalizeAsyncLoads, within its time budget
+	/// </summary>
+	/// <param name="filename">String containing the resource file path</param>
+	/// <param name="id">Enumeration value with which to link the resource, it mustn't be loaded or loading already</param>
+	/// <param name="pool">
+	/// The task pool decoding the resource, the same pool must be used until every asynchronous load is finalized<para/>
+	/// The pool must outlive the holder
+	/// </param>
+	/// <returns>Future set to true once the resource is retrievable, false if it failed to load or if the id is taken</returns>
+	/// <see cref="finalizeAsyncLoads"/>
+	/// <seealso cref="finishAsyncLoads"/>
+	template <typename ID, typename Res>
+	std::shared_future<bool> ResourceHolder<ID, Res>::loadAsync(const std::string& filename, ID id, TaskPool& pool)
+	{
+		assert(!async_pool_ || async_pool_ == &pool);
+
+		// The resource is inserted right away so that the worker can decode into it, the id is taken until it's finalized
+		auto inserted = resource_map_.emplace(std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple());
+		if (!inserted.second) {
+			std::cout << "\nResourceHolder::loadAsync - ID already taken, unable to load " << filename << std::endl;
+			std::promise<bool> rejected;
+			rejected.set_value(false);
+			return rejected.get_future().share();
+		}
+		async_pool_ = &pool;
+
+		auto load(std::make_shared<AsyncLoad>());
+		load->filename = filename;
+		load->id = id;
+		load->res = &inserted.first->second;
+		load->state = AsyncLoad::Queued;
+		load->submitted = pool.getWorkerCount() > 0;
+		std::shared_future<bool> loaded(load->promise.get_future().share());
+
+		if (load->submitted)
+			pool.submit(async_group_, [load]() { decode(*load); });
+		async_loads_.push_back(std::move(load));
+		++async_load_count_;
+		return loaded;
+	}
+
+	/// <summary>
+	/// Inserts the resources decoded in the background into the holder, finishing the work that must happen<para/>
+	/// on the main thread (uploading textures, etc.), until the time budget is spent<para/>
+	/// At least one decoded resource is finalized per call, to be called once per frame while loading
+	/// </summary>
+	/// <param name="budget">The time the call may spend</param>
+	/// <returns>The amount of resources finalized</returns>
+	/// <see cref="loadAsync"/>
+	template <typename ID, typename Res>
+	size_t ResourceHolder<ID, Res>::finalizeAsyncLoads(sf::Time budget)
+	{
+		sf::Clock clock;
+		size_t finalized = 0;
+
+		// Loads are finalized as soon as they're decoded, a large file doesn't hold back the ones submitted after it
+		auto it = async_loads_.begin();
+		while (it != async_loads_.end() && (finalized == 0 || clock.getElapsedTime() < budget)) {
+			AsyncLoad& load = **it;
+			if (!load.submitted)
+				decode(load);
+
+			const int state = load.state.load(std::memory_order_acquire);
+			if (state == AsyncLoad::Queued) {
+				++it;
+				continue;
+			}
+
+			const bool loaded = state == AsyncLoad::Decoded && AsyncLoadTraits<Res>::finalize(load.decoded, *load.res);
+			if (!loaded) {
+				resource_map_.erase(load.id);
+				std::cout << "\nResourceHolder::loadAsync - Failed to load " << load.filename << std::endl;
+			}
+
+			load.promise.set_value(loaded);
+			it = async_loads_.erase(it);
+			++finalized;
+			++finished_async_load_count_;
+		}
+
+		// The pool is released once its tasks are over, the next loads may use another one
+		if (async_loads_.empty()) {
+			async_load_count_ = finished_async_load_count_ = 0;
+			if (async_pool_) {
+				async_pool_->wait(async_group_);
+				async_pool_ = nullptr;
+			}
+		}
+		return finalized;
+	}
+
+	/// <summary>Waits for every asynchronous load and finalizes them, the calling thread is blocked</summary>
+	/// <see cref="loadAsync"/>
+	template <typename ID, typename Res>
+	void ResourceHolder<ID, Res>::finishAsyncLoads()
+	{
+		if (async_pool_)
+			async_pool_->wait(async_group_);
+		while (!async_loads_.empty())
+			finalizeAsyncLoads(sf::Time::Zero);
+	}
+
 	/// <summary>Unloads a resource</summary>
 	/// <param name="id">ID of the resource to unload</param>
 	/// <see cref="load"/>
@@ -43,6 +173,8 @@ namespace au
 	{
 		auto found = resource_map_.find(id);
 		assert(found != resource_map_.end());
+		assert(std::none_of(async_loads_.begin(), async_loads_.end(),
+			                [id](const std::shared_ptr<AsyncLoad>& load) { return load->id == id; }));
 
 		resource_map_.erase(found);
 	}
@@ -82,4 +214,13 @@ namespace au
 		auto inserted = resource_map_.insert(std::make_pair(id, std::move(res)));
 		assert(inserted.second);
 	}
+
+	/// <summary>Decodes an asynchronously loaded resource, may be called by any thread</summary>
+	/// <param name="load">The load</param>
+	template <typename ID, typename Res>
+	void ResourceHolder<ID, Res>::decode(AsyncLoad& load)
+	{
+		const bool decoded = AsyncLoadTraits<Res>::decode(load.filename, load.decoded, *load.res);
+		load.state.store(decoded ? AsyncLoad::Decoded : AsyncLoad::Failed, std::memory_order_release);
+	}
 }
\ No newline at end of file
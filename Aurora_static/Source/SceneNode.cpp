@@ -1,114 +1,342 @@
 #include <cassert>
 #include <functional>
+#include <mutex>
+#include <typeinfo>
 
 #include "SceneNode.h"
+#include "LinearSceneGraph.h"
+#include "EventRouter.h"
+#include "NodeArena.h"
+#include "Profiler.h"
+#include "TaskPool.h"
+#include "RenderQueue.h"
 
 namespace au
 {
+	namespace
+	{
+		static_assert(sf::Event::Count <= 32, "Event subscriptions are stored in a 32-bit mask");
+		const sf::Uint32 AllEventSubscriptions = static_cast<sf::Uint32>((1ull << sf::Event::Count) - 1);
+
+		/// <summary>Handle slot, read without locking when handles are resolved</summary>
+		struct HandleSlot
+		{
+			std::atomic<SceneNode*> node;
+			std::atomic<sf::Uint32> generation;
+		};
+
+		const sf::Uint32 HandleChunkBits = 12;
+		const sf::Uint32 HandleChunkSize = 1u << HandleChunkBits;
+		const sf::Uint32 MaxHandleChunks = 1u << 12;
+		const size_t     HandleBatchSize = 64;
+
+		/// <summary>
+		/// Handle slots shared by all nodes, nodes may be created and destroyed concurrently<para/>
+		/// The slots are allocated in chunks that never move, the mutex only guards the allocation of the chunks<para/>
+		/// and the free slots, which are handed out to the threads in batches
+		/// </summary>
+		struct HandleRegistry
+		{
+			HandleRegistry()
+				: slot_count(0)
+			{
+				for (std::atomic<HandleSlot*>& chunk : chunks)
+					chunk.store(nullptr, std::memory_order_relaxed);
+			}
+
+			std::atomic<HandleSlot*>                   chunks[MaxHandleChunks];
+			std::vector<std::unique_ptr<HandleSlot[]>> owned_chunks;
+			sf::Uint32                                 slot_count;
+			std::vector<sf::Uint32>                    free_slots;
+			std::mutex                                 mutex;
+		};
+
+		/// <summary>Free handle slots owned by a thread, given back to the registry when the thread exits</summary>
+		struct HandleSlotCache
+		{
+			~HandleSlotCache();
+
+			std::vector<sf::Uint32> slots;
+		};
+
+		// Nodes with thread storage duration may outlive the cache, their slots then go straight to the registry
+		thread_local bool handle_slot_cache_destroyed = false;
+
+		// Constructed on first use, nodes with static storage may be constructed before any other global
+		HandleRegistry& getHandleRegistry()
+		{
+			static HandleRegistry registry;
+			return registry;
+		}
+
+		HandleSlotCache& getHandleSlotCache()
+		{
+			thread_local HandleSlotCache cache;
+			return cache;
+		}
+
+		HandleSlot& getHandleSlot(HandleRegistry& registry, sf::Uint32 index)
+		{
+			return registry.chunks[index >> HandleChunkBits].load(std::memory_order_acquire)[index & (HandleChunkSize - 1)];
+		}
+
+		// Moves free slots into a thread's slots, new slots are created once none are free
+		void takeHandleSlots(HandleRegistry& registry, std::vector<sf::Uint32>& slots, size_t count)
+		{
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			while (slots.size() < count && !registry.free_slots.empty()) {
+				slots.push_back(registry.free_slots.back());
+				registry.free_slots.pop_back();
+			}
+			while (slots.size() < count) {
+				const sf::Uint32 chunk = registry.slot_count >> HandleChunkBits;
+				assert(chunk < MaxHandleChunks);
+				if (!registry.chunks[chunk].load(std::memory_order_relaxed)) {
+					registry.owned_chunks.emplace_back(new HandleSlot[HandleChunkSize]());
+					registry.chunks[chunk].store(registry.owned_chunks.back().get(), std::memory_order_release);
+				}
+				slots.push_back(registry.slot_count++);
+			}
+		}
+
+		// Moves a thread's slots back to the registry until it only keeps a given amount
+		void giveHandleSlots(HandleRegistry& registry, std::vector<sf::Uint32>& slots, size_t kept)
+		{
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			registry.free_slots.insert(registry.free_slots.end(), slots.begin() + kept, slots.end());
+			slots.resize(kept);
+		}
+
+		HandleSlotCache::~HandleSlotCache()
+		{
+			giveHandleSlots(getHandleRegistry(), slots, 0);
+			handle_slot_cache_destroyed = true;
+		}
+	}
+
+	const int SceneNode::InheritedRenderLayer;
+
 	SceneNode::SceneNode()
 		: parent_(nullptr)
-		, event_handling_current_(true)
-		, event_handling_children_(true)
-		, updating_current_(true)
-		, updating_children_(true)
-		, drawing_current_(true)
-		, drawing_children_(true)
+		, activation_flags_(ActivationFlag::AllActivationFlags)
+		, linear_storage_(nullptr)
+		, event_router_(nullptr)
+		, event_subscriptions_(AllEventSubscriptions)
+		, thread_safe_(false)
+		, parallel_updating_(false)
+		, arena_allocated_(false)
+		, parallel_update_threshold_(64)
+		, subtree_size_(1)
+		, unsafe_count_(1)
+		, index_in_parent_(0)
+		, render_layer_(InheritedRenderLayer)
 	{
+		acquireHandle();
+		arena_allocated_ = NodeArena::claim(this);
 	}
 
 	SceneNode::SceneNode(const SceneNode& copy)
-		: parent_(copy.parent_)
-		, event_handling_current_(copy.event_handling_current_)
-		, event_handling_children_(copy.event_handling_children_)
-		, updating_current_(copy.updating_current_)
-		, updating_children_(copy.updating_children_)
-		, drawing_current_(copy.drawing_current_)
-		, drawing_children_(copy.drawing_children_)
+		: parent_(nullptr)
+		, activation_flags_(copy.activation_flags_)
+		, linear_storage_(nullptr)
+		, event_router_(nullptr)
+		, event_subscriptions_(copy.event_subscriptions_)
+		, thread_safe_(copy.thread_safe_)
+		, parallel_updating_(copy.parallel_updating_)
+		, arena_allocated_(false)
+		, parallel_update_threshold_(copy.parallel_update_threshold_)
+		, subtree_size_(1)
+		, unsafe_count_(copy.thread_safe_ ? 0 : 1)
+		, index_in_parent_(0)
+		, render_layer_(copy.render_layer_)
 	{
-		for (const auto& child : copy.children_)
-			children_.emplace_back(std::make_unique<SceneNode>(*child));
+		acquireHandle();
+		arena_allocated_ = NodeArena::claim(this);
+
+		// The destructor doesn't run if the copy fails, operator delete must still find the node's arena
+		try {
+			for (const auto& child : copy.children_)
+				if (child) {
+					children_.emplace_back(std::make_unique<SceneNode>(*child));
+					children_.back()->parent_ = this;
+					children_.back()->index_in_parent_ = static_cast<sf::Uint32>(children_.size() - 1);
+					subtree_size_ += children_.back()->subtree_size_;
+					unsafe_count_ += children_.back()->unsafe_count_;
+				}
+
+			if (copy.linear_storage_)
+				activateLinearStorage(true);
+			if (copy.event_router_)
+				activateEventRouting(true);
+		}
+		catch (...) {
+			children_.clear();
+			if (arena_allocated_)
+				NodeArena::release(this);
+			throw;
+		}
 	}
 
 	SceneNode::~SceneNode()
 	{
+		HandleRegistry& registry = getHandleRegistry();
+		HandleSlot& slot = getHandleSlot(registry, handle_.index);
+		slot.node.store(nullptr);
+		slot.generation.fetch_add(1);
+
+		if (handle_slot_cache_destroyed) {
+			std::vector<sf::Uint32> slots(1, handle_.index);
+			giveHandleSlots(registry, slots, 0);
+		}
+		else {
+			std::vector<sf::Uint32>& slots = getHandleSlotCache().slots;
+			slots.push_back(handle_.index);
+			if (slots.size() >= 2 * HandleBatchSize)
+				giveHandleSlots(registry, slots, HandleBatchSize);
+		}
+
+		// The children are destroyed first so that the node's memory is the next to be deallocated
+		children_.clear();
+		if (arena_allocated_)
+			NodeArena::release(this);
+	}
+
+	void* SceneNode::operator new(size_t size)
+	{
+		return NodeArena::allocate(size);
+	}
+
+	void SceneNode::operator delete(void* memory, size_t size)
+	{
+		NodeArena::deallocate(memory, size);
 	}
 
 	void SceneNode::attachChild(NodePtr child)
 	{
 		child->parent_ = this;
+		child->index_in_parent_ = static_cast<sf::Uint32>(children_.size());
+		child->invalidateWorldTransform();
+		propagateSubtreeCounts(static_cast<int>(child->subtree_size_), static_cast<int>(child->unsafe_count_));
 		children_.push_back(std::move(child));
+		notifySubtreeChange(SubtreeChange::StructureChange);
+
+		onChildAttached(*children_.back());
 	}
 
 	SceneNode::NodePtr SceneNode::detachChild(const SceneNode& child)
 	{
-		auto found = std::find_if(children_.begin(), children_.end(), [&child](NodePtr& p) {
-			return p.get() == &child;
-		});
-		assert(found != children_.end());
+		assert(child.parent_ == this && children_[child.index_in_parent_].get() == &child);
 
-		NodePtr result = std::move(*found);
+		onChildDetached(*children_[child.index_in_parent_]);
+
+		// The hole keeps the siblings' indices valid until the next compaction
+		NodePtr result = std::move(children_[child.index_in_parent_]);
 		result->parent_ = nullptr;
-		children_.erase(found);
+		result->invalidateWorldTransform();
+		propagateSubtreeCounts(-static_cast<int>(result->subtree_size_), -static_cast<int>(result->unsafe_count_));
+		notifySubtreeChange(SubtreeChange::StructureChange);
 
 		return std::move(result);
 	}
 
 	void SceneNode::handleEvent(const sf::Event& event)
 	{
-		if (event_handling_current_) handleEventCurrent(event);
-		if (event_handling_children_) handleEventChildren(event);
+		AU_PROFILE_NODE_SCOPE(*this, "handleEvent");
+
+		if (event_router_)
+			event_router_->dispatch(event);
+		else if (linear_storage_)
+			linear_storage_->handleEvent(event);
+		else {
+			if (activation_flags_ & ActivationFlag::EventHandlingCurrent) {
+				AU_PROFILE_NODE_SCOPE(*this, "handleEventCurrent");
+				handleEventCurrent(event);
+			}
+			if (activation_flags_ & ActivationFlag::EventHandlingChildren) handleEventChildren(event);
+		}
 	}
 
 	void SceneNode::update(sf::Time dt)
 	{
-		removeChildrenMarkedForRemoval();
+		AU_PROFILE_NODE_SCOPE(*this, "update");
 
-		if (updating_current_) updateCurrent(dt);
-		if (updating_children_) updateChildren(dt);
+		if (linear_storage_)
+			linear_storage_->update(dt);
+		else {
+			removeChildrenMarkedForRemoval();
+
+			if (activation_flags_ & ActivationFlag::UpdatingCurrent) {
+				AU_PROFILE_NODE_SCOPE(*this, "updateCurrent");
+				updateCurrent(dt);
+			}
+			if (activation_flags_ & ActivationFlag::UpdatingChildren) updateChildren(dt);
+		}
 	}
 
 	void SceneNode::activateEventHandling(SceneNode::ActivationTarget target, bool flag)
 	{
-		switch (target) {
-		case ActivationTarget::Current:
-			event_handling_current_ = flag;
-			break;
-		case ActivationTarget::Children:
-			event_handling_children_ = flag;
-			break;
-		case ActivationTarget::All:
-			event_handling_current_ = flag;
-			event_handling_children_ = flag;
-		}
+		setActivationFlags(target, ActivationFlag::EventHandlingCurrent, ActivationFlag::EventHandlingChildren, flag);
 	}
 
 	void SceneNode::activateUpdating(SceneNode::ActivationTarget target, bool flag)
 	{
-		switch (target) {
-		case ActivationTarget::Current:
-			updating_current_ = flag;
-			break;
-		case ActivationTarget::Children:
-			updating_children_ = flag;
-			break;
-		case ActivationTarget::All:
-			updating_current_ = flag;
-			updating_children_ = flag;
-		}
+		setActivationFlags(target, ActivationFlag::UpdatingCurrent, ActivationFlag::UpdatingChildren, flag);
 	}
 
 	void SceneNode::activateDrawing(SceneNode::ActivationTarget target, bool flag)
 	{
-		switch (target) {
-		case ActivationTarget::Current:
-			drawing_current_ = flag;
-			break;
-		case ActivationTarget::Children:
-			drawing_children_ = flag;
-			break;
-		case ActivationTarget::All:
-			drawing_current_ = flag;
-			drawing_children_ = flag;
+		setActivationFlags(target, ActivationFlag::DrawingCurrent, ActivationFlag::DrawingChildren, flag);
+	}
+
+	void SceneNode::activateLinearStorage(bool flag)
+	{
+		if (flag && !linear_storage_)
+			linear_storage_ = std::make_unique<LinearSceneGraph>(*this);
+		else if (!flag)
+			linear_storage_.reset();
+	}
+
+	void SceneNode::activateEventRouting(bool flag)
+	{
+		if (flag && !event_router_)
+			event_router_ = std::make_unique<EventRouter>(*this);
+		else if (!flag)
+			event_router_.reset();
+	}
+
+	void SceneNode::setEventSubscriptions(std::initializer_list<sf::Event::EventType> types)
+	{
+		sf::Uint32 subscriptions = 0;
+		for (sf::Event::EventType type : types)
+			subscriptions |= 1u << type;
+
+		if (event_subscriptions_ != subscriptions) {
+			event_subscriptions_ = subscriptions;
+			notifySubtreeChange(SubtreeChange::SubscriptionChange);
+		}
+	}
+
+	void SceneNode::subscribeToEvent(sf::Event::EventType type, bool flag)
+	{
+		const sf::Uint32 subscriptions = flag ? (event_subscriptions_ | 1u << type) : (event_subscriptions_ & ~(1u << type));
+		if (event_subscriptions_ != subscriptions) {
+			event_subscriptions_ = subscriptions;
+			notifySubtreeChange(SubtreeChange::SubscriptionChange);
+		}
+	}
+
+	void SceneNode::activateParallelUpdating(bool flag)
+	{
+		parallel_updating_ = flag;
+	}
+
+	void SceneNode::declareThreadSafe(bool flag)
+	{
+		if (thread_safe_ != flag) {
+			thread_safe_ = flag;
+			propagateSubtreeCounts(0, flag ? -1 : 1);
 		}
 	}
 
@@ -119,26 +347,210 @@ namespace au
 
 	bool SceneNode::isDestroyed() const
 	{
-		return parent_ != nullptr;
+		return false;
+	}
+
+	SceneNode* SceneNode::resolve(Handle handle)
+	{
+		HandleRegistry& registry = getHandleRegistry();
+		if ((handle.index >> HandleChunkBits) >= MaxHandleChunks)
+			return nullptr;
+		const HandleSlot* chunk = registry.chunks[handle.index >> HandleChunkBits].load(std::memory_order_acquire);
+		if (!chunk)
+			return nullptr;
+
+		// The generation is checked again in case the node was destroyed while it was read
+		const HandleSlot& slot = chunk[handle.index & (HandleChunkSize - 1)];
+		if (slot.generation.load() != handle.generation)
+			return nullptr;
+		SceneNode* node = slot.node.load();
+		return slot.generation.load() == handle.generation ? node : nullptr;
+	}
+
+	void SceneNode::enqueue(RenderQueue& queue, sf::RenderStates states) const
+	{
+		enqueueSubtree(queue, states, 0);
 	}
 
 	void SceneNode::draw(sf::RenderTarget& target, sf::RenderStates states) const
 	{
-		if (drawing_current_) drawCurrent(target, states);
-		if (drawing_children_) drawChildren(target, states);
+		AU_PROFILE_NODE_SCOPE(*this, "draw");
+
+		if (linear_storage_)
+			linear_storage_->draw(target, states);
+		else {
+			if (activation_flags_ & ActivationFlag::DrawingCurrent) {
+				AU_PROFILE_NODE_SCOPE(*this, "drawCurrent");
+				drawCurrent(target, states);
+			}
+			if (activation_flags_ & ActivationFlag::DrawingChildren) drawChildren(target, states);
+		}
+	}
+
+	void SceneNode::enqueueSubtree(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		if (render_layer_ != InheritedRenderLayer)
+			layer = render_layer_;
+
+		if (linear_storage_)
+			linear_storage_->enqueue(queue, states, layer);
+		else {
+			if (activation_flags_ & ActivationFlag::DrawingCurrent) enqueueCurrent(queue, states, layer);
+			if (activation_flags_ & ActivationFlag::DrawingChildren) enqueueChildren(queue, states, layer);
+		}
+	}
+
+	void SceneNode::enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		// Plain nodes don't draw anything, they would only split the batches
+		if (typeid(*this) != typeid(SceneNode))
+			queue.submit(*this, states, layer);
+	}
+
+	void SceneNode::invalidateWorldTransform()
+	{
+		for (NodePtr& child : children_)
+			if (child)
+				child->invalidateWorldTransform();
+	}
+
+	void SceneNode::cacheWorldTransform() const
+	{
+		if (parent_)
+			parent_->cacheWorldTransform();
 	}
 
 	void SceneNode::removeChildrenMarkedForRemoval()
 	{
-		std::remove_if(children_.begin(), children_.end(), [](NodePtr& child) {
-			return child->isMarkedForRemoval();
-		});
+		bool removed = false;
+		size_t kept = 0;
+		for (size_t i = 0; i < children_.size(); ++i) {
+			NodePtr& child = children_[i];
+			if (!child)
+				continue;
+
+			if (child->isMarkedForRemoval()) {
+				onChildDetached(*child);
+				propagateSubtreeCounts(-static_cast<int>(child->subtree_size_), -static_cast<int>(child->unsafe_count_));
+				child.reset();
+				removed = true;
+			}
+			else {
+				if (kept != i)
+					children_[kept] = std::move(child);
+				children_[kept]->index_in_parent_ = static_cast<sf::Uint32>(kept);
+				kept++;
+			}
+		}
+		children_.resize(kept);
+
+		if (removed)
+			notifySubtreeChange(SubtreeChange::StructureChange);
+	}
+
+	void SceneNode::onChildAttached(SceneNode& child)
+	{
+	}
+
+	void SceneNode::onChildDetached(SceneNode& child)
+	{
+	}
+
+	void SceneNode::acquireHandle()
+	{
+		HandleRegistry& registry = getHandleRegistry();
+		if (handle_slot_cache_destroyed) {
+			std::vector<sf::Uint32> slots;
+			takeHandleSlots(registry, slots, 1);
+			handle_.index = slots.back();
+		}
+		else {
+			std::vector<sf::Uint32>& slots = getHandleSlotCache().slots;
+			if (slots.empty())
+				takeHandleSlots(registry, slots, HandleBatchSize);
+			handle_.index = slots.back();
+			slots.pop_back();
+		}
+
+		HandleSlot& slot = getHandleSlot(registry, handle_.index);
+		handle_.generation = slot.generation.load();
+		slot.node.store(this);
+	}
+
+	void SceneNode::setActivationFlags(ActivationTarget target, sf::Uint8 current_flag, sf::Uint8 children_flag, bool flag)
+	{
+		sf::Uint8 flags = 0;
+		switch (target) {
+		case ActivationTarget::Current:
+			flags = current_flag;
+			break;
+		case ActivationTarget::Children:
+			flags = children_flag;
+			break;
+		case ActivationTarget::All:
+			flags = current_flag | children_flag;
+		}
+
+		const sf::Uint8 previous_flags = activation_flags_;
+		activation_flags_ = flag ? (activation_flags_ | flags) : (activation_flags_ & ~flags);
+		if (activation_flags_ != previous_flags)
+			notifySubtreeChange(SubtreeChange::ActivationChange);
+	}
+
+	void SceneNode::propagateSubtreeCounts(int size, int unsafe_count)
+	{
+		// Concurrently updated subtrees may attach or detach nodes, their ancestors are shared
+		for (SceneNode* node = this; node; node = node->parent_) {
+			node->subtree_size_.fetch_add(static_cast<sf::Uint32>(size), std::memory_order_relaxed);
+			node->unsafe_count_.fetch_add(static_cast<sf::Uint32>(unsafe_count), std::memory_order_relaxed);
+		}
+	}
+
+	void SceneNode::notifySubtreeChange(sf::Uint8 changes)
+	{
+		for (SceneNode* node = this; node; node = node->parent_) {
+			if (node->linear_storage_)
+				node->linear_storage_->invalidate(changes);
+			if (node->event_router_)
+				node->event_router_->invalidate(changes);
+		}
+	}
+
+	void SceneNode::updateChildrenInParallel(sf::Time dt)
+	{
+		// The subtrees only read the world transforms of their ancestors while they're updated concurrently
+		cacheWorldTransform();
+
+		TaskPool& pool = TaskPool::getDefault();
+		TaskPool::Group group;
+		std::vector<SceneNode*> unsafe_children;
+		std::vector<SceneNode*> small_children;
+		for (NodePtr& child : children_) {
+			SceneNode* node = child.get();
+			if (!node)
+				continue;
+			if (node->unsafe_count_ > 0)
+				unsafe_children.push_back(node);
+			else if (node->subtree_size_ < parallel_update_threshold_)
+				small_children.push_back(node);
+			else
+				pool.submit(group, [node, dt]() { node->update(dt); });
+		}
+
+		for (SceneNode* child : small_children)
+			child->update(dt);
+		pool.wait(group);
+
+		for (SceneNode* child : unsafe_children)
+			child->update(dt);
 	}
 
 	void SceneNode::handleEventChildren(const sf::Event& event)
 	{
-		for (NodePtr& child : children_)
-			child->handleEvent(event);
+		// Children attached while iterating are only appended, detached ones leave a hole
+		for (size_t i = 0; i < children_.size(); ++i)
+			if (children_[i])
+				children_[i]->handleEvent(event);
 	}
 
 	void SceneNode::handleEventCurrent(const sf::Event& event)
@@ -147,8 +559,14 @@ namespace au
 
 	void SceneNode::updateChildren(sf::Time dt)
 	{
-		for (NodePtr& child : children_)
-			child->update(dt);
+		if (parallel_updating_ && children_.size() > 1) {
+			updateChildrenInParallel(dt);
+			return;
+		}
+
+		for (size_t i = 0; i < children_.size(); ++i)
+			if (children_[i])
+				children_[i]->update(dt);
 	}
 
 	void SceneNode::updateCurrent(sf::Time dt)
@@ -158,7 +576,15 @@ namespace au
 	void SceneNode::drawChildren(sf::RenderTarget& target, sf::RenderStates states) const
 	{
 		for (const auto& child : children_)
-			child->draw(target, states);
+			if (child)
+				child->draw(target, states);
+	}
+
+	void SceneNode::enqueueChildren(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		for (const auto& child : children_)
+			if (child)
+				child->enqueueSubtree(queue, states, layer);
 	}
 
 	void SceneNode::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
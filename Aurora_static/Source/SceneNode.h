@@ -1,15 +1,23 @@
 #ifndef Aurora_SceneNode_H_
 #define Aurora_SceneNode_H_
 
+#include <atomic>
+#include <initializer_list>
+#include <limits>
 #include <memory>
 #include <vector>
 
+#include <SFML/Config.hpp>
 #include <SFML/System/Time.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Graphics/Drawable.hpp>
 
 namespace au
 {
+	class LinearSceneGraph;
+	class EventRouter;
+	class RenderQueue;
+
 	/// <summary>
 	/// Base class for scene graph architecture<para/>
 	/// Provides functionality for attaching/detaching children nodes,<para/>
@@ -23,8 +31,44 @@ namespace au
 	public:
 		/// <summary>Used to (de)activate event handling, updating or drawing</summary>
 		enum class ActivationTarget { Current, Children, All };
+		/// <summary>Render layer value making a node use its parent's render layer</summary>
+		static const int InheritedRenderLayer = std::numeric_limits<int>::min();
+		/// <summary>
+		/// Weak reference to a node that detects whether the node still exists<para/>
+		/// The generation of a handle slot is incremented whenever its node is destroyed
+		/// </summary>
+		/// <see cref="getHandle"/>
+		/// <see cref="resolve"/>
+		struct Handle
+		{
+			sf::Uint32 index      = static_cast<sf::Uint32>(-1);
+			sf::Uint32 generation = 0;
+
+			inline bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+			inline bool operator!=(const Handle& other) const { return !(*this == other); }
+		};
 	private:
 		using NodePtr = std::unique_ptr<SceneNode>;
+		/// <summary>Bit flags for event handling, updating and drawing activation</summary>
+		enum ActivationFlag : sf::Uint8 {
+			EventHandlingCurrent  = 1 << 0,
+			EventHandlingChildren = 1 << 1,
+			UpdatingCurrent       = 1 << 2,
+			UpdatingChildren      = 1 << 3,
+			DrawingCurrent        = 1 << 4,
+			DrawingChildren       = 1 << 5,
+			AllActivationFlags    = (1 << 6) - 1
+		};
+		/// <summary>Bit flags for the changes of a subtree reported to the linear storages and event routers containing it</summary>
+		enum SubtreeChange : sf::Uint8 {
+			StructureChange    = 1 << 0,
+			ActivationChange   = 1 << 1,
+			SubscriptionChange = 1 << 2
+		};
+		friend class LinearSceneGraph;
+		friend class EventRouter;
+		friend class RenderQueue;
+		friend class CullingLayer;
 
 	public:
 		/// <summary>
@@ -38,11 +82,23 @@ namespace au
 		/// <summary>Virtual destructor</summary>
 		virtual ~SceneNode();
 	public:
+		/// <summary>Allocates a node from the arena creating it, from the global heap otherwise</summary>
+		/// <param name="size">The node's size</param>
+		/// <returns>The node's memory</returns>
+		/// <see cref="NodeArena::create"/>
+		static void* operator new(size_t size);
+		/// <summary>Returns a node's memory to the arena it was allocated from or to the global heap</summary>
+		/// <param name="memory">The node's memory</param>
+		/// <param name="size">The node's size</param>
+		static void operator delete(void* memory, size_t size);
 		/// <summary>Attaches a child node to this node</summary>
 		/// <param name="child">SceneNode (or SceneNode derivative) unique_ptr created before calling this method</param>
 		/// <see cref="detachChild"/>
 		void attachChild(NodePtr child);
-		/// <summary>Detaches a child node and returns it, detached node will by destroyed if not retrieved</summary>
+		/// <summary>
+		/// Detaches a child node and returns it, detached node will by destroyed if not retrieved<para/>
+		/// Detaching is done in constant time, the hole left in the children is compacted during the next update
+		/// </summary>
 		/// <param name="child">Stored child node</param>
 		/// <returns>Detached child node</returns>
 		/// <see cref="attachChild"/>
@@ -80,6 +136,82 @@ namespace au
 		/// <see cref="activateUpdating"/>
 		void activateDrawing(ActivationTarget target, bool flag);
 		/// <summary>
+		/// (De)Activates linear storage for this node's subtree (should be used on a root node)<para/>
+		/// The subtree is flattened into contiguous depth-first arrays that are walked linearly<para/>
+		/// by handleEvent, update and draw, the flattened arrays are rebuilt whenever the scene's<para/>
+		/// structure or activation flags change<para/>
+		/// The handleEventCurrent, updateCurrent and drawCurrent methods are still called for every node<para/>
+		/// but overriden draw methods are bypassed for the nodes inside the subtree
+		/// </summary>
+		/// <param name="flag">True to activate, false to deactivate</param>
+		/// <see cref="getLinearStorage"/>
+		void activateLinearStorage(bool flag);
+		/// <summary>Returns the linear storage of this node's subtree</summary>
+		/// <returns>The linear storage if it's active, nullptr otherwise</returns>
+		/// <see cref="activateLinearStorage"/>
+		inline LinearSceneGraph* getLinearStorage() const { return linear_storage_.get(); }
+		/// <summary>
+		/// (De)Activates event routing for this node's subtree (should be used on a root node)<para/>
+		/// Events are only sent to the nodes subscribed to their type instead of being broadcast<para/>
+		/// through the whole subtree, nodes are subscribed to every event type by default<para/>
+		/// Takes precedence over the linear storage's event handling
+		/// </summary>
+		/// <param name="flag">True to activate, false to deactivate</param>
+		/// <see cref="setEventSubscriptions"/>
+		/// <see cref="getEventRouter"/>
+		void activateEventRouting(bool flag);
+		/// <summary>Returns the event router of this node's subtree</summary>
+		/// <returns>The event router if it's active, nullptr otherwise</returns>
+		/// <see cref="activateEventRouting"/>
+		inline EventRouter* getEventRouter() const { return event_router_.get(); }
+		/// <summary>
+		/// Sets the event types the node's handleEventCurrent method is called for when events are routed<para/>
+		/// Nodes are subscribed to every event type by default, engine nodes that don't handle events (MaterialNode,<para/>
+		/// ParticleSystem, Animation, etc.) to none, subscriptions are ignored when events are broadcast
+		/// </summary>
+		/// <param name="types">The event types</param>
+		/// <see cref="subscribeToEvent"/>
+		/// <see cref="activateEventRouting"/>
+		void setEventSubscriptions(std::initializer_list<sf::Event::EventType> types);
+		/// <summary>(Un)Subscribes the node to an event type</summary>
+		/// <param name="type">The event type</param>
+		/// <param name="flag">True to subscribe, false to unsubscribe</param>
+		/// <see cref="setEventSubscriptions"/>
+		void subscribeToEvent(sf::Event::EventType type, bool flag);
+		/// <summary>Checks if the node is subscribed to an event type</summary>
+		/// <param name="type">The event type</param>
+		/// <returns>True if it's subscribed, false otherwise</returns>
+		/// <see cref="subscribeToEvent"/>
+		inline bool isSubscribedToEvent(sf::Event::EventType type) const { return (event_subscriptions_ & (1u << type)) != 0; }
+		/// <summary>
+		/// (De)Activates parallel updating of this node's children<para/>
+		/// Children subtrees that only contain thread-safe nodes and whose size reaches the threshold<para/>
+		/// are updated concurrently on the default task pool, the remaining thread-safe subtrees are<para/>
+		/// updated on the calling thread in the meantime, the other subtrees are updated in order once<para/>
+		/// the concurrent updates are finished<para/>
+		/// Nodes updated by a linear storage are always updated sequentially
+		/// </summary>
+		/// <param name="flag">True to activate, false to deactivate</param>
+		/// <see cref="setParallelUpdateThreshold"/>
+		/// <see cref="declareThreadSafe"/>
+		void activateParallelUpdating(bool flag);
+		/// <summary>Sets the minimum amount of nodes a child subtree must contain to be updated concurrently</summary>
+		/// <param name="threshold">The minimum amount of nodes (64 by default)</param>
+		/// <see cref="activateParallelUpdating"/>
+		inline void setParallelUpdateThreshold(size_t threshold) { parallel_update_threshold_ = threshold; }
+		/// <summary>
+		/// Declares whether the node can be updated concurrently with nodes outside of its subtree<para/>
+		/// A thread-safe node's updateCurrent method only modifies the node itself or its subtree<para/>
+		/// and only reads the world transforms of its ancestors<para/>
+		/// Nodes aren't thread-safe by default, plain SceneNode layers can be declared thread-safe by the user
+		/// </summary>
+		/// <param name="flag">True if the node is thread-safe, false otherwise</param>
+		/// <see cref="activateParallelUpdating"/>
+		void declareThreadSafe(bool flag);
+		/// <summary>Returns the amount of nodes in the subtree (the node included)</summary>
+		/// <returns>The amount of nodes</returns>
+		inline size_t getSubtreeSize() const { return subtree_size_.load(std::memory_order_relaxed); }
+		/// <summary>
 		/// Informs the user if the node must be removed from the scene<para/>
 		/// Removal condition is defined by the user<para/>
 		/// Nodes that are marked for removal are automatically removed from the scene
@@ -96,6 +228,38 @@ namespace au
 		/// <returns>True if the node is destroyed, false otherwise</returns>
 		/// <see cref="isMarkedForRemoval"/>
 		virtual bool isDestroyed() const;
+		/// <summary>Returns the node's parent</summary>
+		/// <returns>The parent node, nullptr if the node isn't attached</returns>
+		inline SceneNode* getParent() const { return parent_; }
+		/// <summary>Returns the node's handle, which can be resolved safely after the node is destroyed</summary>
+		/// <returns>The node's handle</returns>
+		/// <see cref="resolve"/>
+		inline Handle getHandle() const { return handle_; }
+		/// <summary>Retrieves the node referenced by a handle, handles are resolved without locking</summary>
+		/// <param name="handle">The node's handle</param>
+		/// <returns>The node, nullptr if the node was destroyed</returns>
+		/// <see cref="getHandle"/>
+		static SceneNode* resolve(Handle handle);
+		/// <summary>
+		/// Collects the draw items of the current node and all of its children nodes into a render queue<para/>
+		/// The render queue is drawn afterwards through its flush method
+		/// </summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <see cref="setRenderLayer"/>
+		/// <seealso cref="enqueueCurrent"/>
+		void enqueue(RenderQueue& queue, sf::RenderStates states = sf::RenderStates::Default) const;
+		/// <summary>
+		/// Sets the render layer used by the render queue for the node and its children nodes<para/>
+		/// Lower layers are drawn first, the root node uses layer 0 unless specified
+		/// </summary>
+		/// <param name="layer">The render layer, InheritedRenderLayer to use the parent's layer</param>
+		/// <see cref="getRenderLayer"/>
+		inline void setRenderLayer(int layer) { render_layer_ = layer; }
+		/// <summary>Returns the render layer set for the node</summary>
+		/// <returns>The render layer, InheritedRenderLayer if the parent's layer is used</returns>
+		/// <see cref="setRenderLayer"/>
+		inline int getRenderLayer() const { return render_layer_; }
 	protected:
 		/// <summary>Draws the current node and all of its children nodes</summary>
 		/// <param name="target">Render target (window, render texture)</param>
@@ -105,10 +269,75 @@ namespace au
 		/// <seealso cref="drawChildren"/>
 		/// <seealso cref="drawCurrent"/>
 		virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+		/// <summary>
+		/// Invalidates any cached world transform of the current node and all of its children nodes<para/>
+		/// Called whenever the node is (re)attached or detached
+		/// </summary>
+		/// <see cref="MaterialNode::getWorldTransform"/>
+		virtual void invalidateWorldTransform();
+		/// <summary>
+		/// Computes any world transform shared by the node's subtree ahead of time<para/>
+		/// Called before the children are updated concurrently, so they only read the cached transforms
+		/// </summary>
+		/// <see cref="MaterialNode::getWorldTransform"/>
+		virtual void cacheWorldTransform() const;
+		/// <summary>Collects the draw items of the current node and all of its children nodes</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The parent's render layer</param>
+		/// <see cref="enqueue"/>
+		virtual void enqueueSubtree(RenderQueue& queue, sf::RenderStates states, int layer) const;
+		/// <summary>
+		/// Submits the current node's draw items to the render queue<para/>
+		/// By default the node is submitted as a whole and its drawCurrent method is called when the queue<para/>
+		/// is flushed, which prevents merging, classes deriving from a class that overrides this method<para/>
+		/// and that override drawCurrent must override this method too
+		/// </summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The node's render layer</param>
+		/// <see cref="enqueue"/>
+		/// <seealso cref="drawCurrent"/>
+		virtual void enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const;
 	private:
-		/// <summary>Remove all children nodes that are marked for removal</summary>
+		/// <summary>
+		/// Remove all children nodes that are marked for removal<para/>
+		/// The children are compacted in a single pass that also fills the holes left by detached children
+		/// </summary>
 		/// <see cref="isMarkedForRemoval"/>
 		void removeChildrenMarkedForRemoval();
+		/// <summary>Called after a child node was attached to the current node</summary>
+		/// <param name="child">The attached child node</param>
+		/// <see cref="attachChild"/>
+		virtual void onChildAttached(SceneNode& child);
+		/// <summary>Called before a child node is detached or removed from the current node</summary>
+		/// <param name="child">The child node</param>
+		/// <see cref="detachChild"/>
+		/// <seealso cref="removeChildrenMarkedForRemoval"/>
+		virtual void onChildDetached(SceneNode& child);
+		/// <summary>Sets or clears activation flags depending on the activation target</summary>
+		/// <param name="target">Current node, its children or all of them</param>
+		/// <param name="current_flag">The flag affecting the current node</param>
+		/// <param name="children_flag">The flag affecting the children nodes</param>
+		/// <param name="flag">True to set the flags, false to clear them</param>
+		void setActivationFlags(ActivationTarget target, sf::Uint8 current_flag, sf::Uint8 children_flag, bool flag);
+		/// <summary>Adds the amount of nodes and unsafe nodes to the current node and all of its ancestors</summary>
+		/// <param name="size">The amount of nodes added (negative if removed)</param>
+		/// <param name="unsafe_count">The amount of unsafe nodes added (negative if removed)</param>
+		void propagateSubtreeCounts(int size, int unsafe_count);
+		/// <summary>
+		/// Informs the linear storages and event routers of the current node and its ancestors that their subtree<para/>
+		/// changed, only those are rebuilt, the other subtrees of the scene aren't affected
+		/// </summary>
+		/// <param name="changes">The subtree changes</param>
+		void notifySubtreeChange(sf::Uint8 changes);
+		/// <summary>Registers the node in a free handle slot</summary>
+		/// <see cref="getHandle"/>
+		void acquireHandle();
+		/// <summary>Updates the children nodes, concurrently for the large thread-safe subtrees</summary>
+		/// <param name="dt">Time passed for current frame</param>
+		/// <see cref="activateParallelUpdating"/>
+		void updateChildrenInParallel(sf::Time dt);
 		/// <summary>Sends event to all children nodes</summary>
 		/// <param name="event">Polled input event</param>
 		/// <see cref="handleEvent"/>
@@ -140,7 +369,13 @@ namespace au
 		/// <param name="states">Render states (transform, texture)</param>
 		/// <see cref="draw"/>
 		/// <see cref="drawCurrent"/>
-		void drawChildren(sf::RenderTarget& target, sf::RenderStates states) const;
+		virtual void drawChildren(sf::RenderTarget& target, sf::RenderStates states) const;
+		/// <summary>Collects the draw items of all children nodes</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The current node's render layer</param>
+		/// <see cref="enqueueSubtree"/>
+		virtual void enqueueChildren(RenderQueue& queue, sf::RenderStates states, int layer) const;
 		/// <summary>
 		/// Draws current node<para/>
 		/// Method is defined by the user
@@ -154,13 +389,20 @@ namespace au
 	protected:
 		SceneNode*           parent_;
 	private:
-		std::vector<NodePtr> children_;
-		bool                 event_handling_current_;
-		bool                 event_handling_children_;
-		bool                 updating_current_;
-		bool                 updating_children_;
-		bool                 drawing_current_;
-		bool                 drawing_children_;
+		std::vector<NodePtr>              children_;
+		sf::Uint8                         activation_flags_;
+		std::unique_ptr<LinearSceneGraph> linear_storage_;
+		std::unique_ptr<EventRouter>      event_router_;
+		sf::Uint32                        event_subscriptions_;
+		bool                              thread_safe_;
+		bool                              parallel_updating_;
+		bool                              arena_allocated_;
+		size_t                            parallel_update_threshold_;
+		std::atomic<sf::Uint32>           subtree_size_;
+		std::atomic<sf::Uint32>           unsafe_count_;
+		sf::Uint32                        index_in_parent_;
+		Handle                            handle_;
+		int                               render_layer_;
 	};
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <cassert>
+
+#include "SpatialIndex.h"
+
+namespace au
+{
+	namespace
+	{
+		sf::FloatRect combine(const sf::FloatRect& lhs, const sf::FloatRect& rhs)
+		{
+			const float left = std::min(lhs.left, rhs.left);
+			const float top = std::min(lhs.top, rhs.top);
+			const float right = std::max(lhs.left + lhs.width, rhs.left + rhs.width);
+			const float bottom = std::max(lhs.top + lhs.height, rhs.top + rhs.height);
+
+			return sf::FloatRect(left, top, right - left, bottom - top);
+		}
+
+		bool contains(const sf::FloatRect& outer, const sf::FloatRect& inner)
+		{
+			return outer.left <= inner.left && outer.top <= inner.top
+			    && outer.left + outer.width >= inner.left + inner.width
+			    && outer.top + outer.height >= inner.top + inner.height;
+		}
+
+		float getPerimeter(const sf::FloatRect& rect)
+		{
+			return 2.f * (rect.width + rect.height);
+		}
+	}
+
+	const SpatialIndex::ProxyId SpatialIndex::NullProxy;
+
+	SpatialIndex::SpatialIndex(float margin)
+		: root_(NullProxy)
+		, free_list_(NullProxy)
+		, proxy_count_(0)
+		, margin_(margin)
+	{
+	}
+
+	SpatialIndex::ProxyId SpatialIndex::createProxy(const sf::FloatRect& bounds, MaterialNode* node)
+	{
+		const ProxyId proxy = allocateNode();
+		nodes_[proxy].bounds = sf::FloatRect(bounds.left - margin_, bounds.top - margin_,
+		                                     bounds.width + 2.f * margin_, bounds.height + 2.f * margin_);
+		nodes_[proxy].node = node;
+		nodes_[proxy].height = 0;
+		insertLeaf(proxy);
+		proxy_count_++;
+
+		return proxy;
+	}
+
+	void SpatialIndex::destroyProxy(ProxyId proxy)
+	{
+		assert(proxy >= 0 && proxy < static_cast<ProxyId>(nodes_.size()) && nodes_[proxy].isLeaf());
+
+		removeLeaf(proxy);
+		freeNode(proxy);
+		proxy_count_--;
+	}
+
+	bool SpatialIndex::moveProxy(ProxyId proxy, const sf::FloatRect& bounds)
+	{
+		assert(proxy >= 0 && proxy < static_cast<ProxyId>(nodes_.size()) && nodes_[proxy].isLeaf());
+
+		if (contains(nodes_[proxy].bounds, bounds))
+			return false;
+
+		removeLeaf(proxy);
+		nodes_[proxy].bounds = sf::FloatRect(bounds.left - margin_, bounds.top - margin_,
+		                                     bounds.width + 2.f * margin_, bounds.height + 2.f * margin_);
+		insertLeaf(proxy);
+
+		return true;
+	}
+
+	SpatialIndex::ProxyId SpatialIndex::allocateNode()
+	{
+		if (free_list_ == NullProxy) {
+			nodes_.emplace_back();
+			nodes_.back().parent = NullProxy;
+			nodes_.back().height = -1;
+			free_list_ = static_cast<ProxyId>(nodes_.size() - 1);
+		}
+
+		const ProxyId id = free_list_;
+		free_list_ = nodes_[id].parent;
+
+		nodes_[id].node = nullptr;
+		nodes_[id].parent = NullProxy;
+		nodes_[id].left = NullProxy;
+		nodes_[id].right = NullProxy;
+		nodes_[id].height = 0;
+		return id;
+	}
+
+	void SpatialIndex::freeNode(ProxyId id)
+	{
+		nodes_[id].parent = free_list_;
+		nodes_[id].height = -1;
+		free_list_ = id;
+	}
+
+	void SpatialIndex::insertLeaf(ProxyId leaf)
+	{
+		if (root_ == NullProxy) {
+			root_ = leaf;
+			nodes_[leaf].parent = NullProxy;
+			return;
+		}
+
+		// Descend towards the cheapest sibling, the cost being the perimeter added to the tree
+		const sf::FloatRect leaf_bounds = nodes_[leaf].bounds;
+		ProxyId sibling = root_;
+		while (!nodes_[sibling].isLeaf()) {
+			const Node& node = nodes_[sibling];
+			const float perimeter = getPerimeter(node.bounds);
+			const float combined_perimeter = getPerimeter(combine(node.bounds, leaf_bounds));
+
+			// Cost of creating a new parent for this node and the leaf, and the cost pushed down to the children
+			const float cost = 2.f * combined_perimeter;
+			const float inheritance_cost = 2.f * (combined_perimeter - perimeter);
+
+			const auto getDescendingCost = [&](ProxyId child) {
+				const float child_perimeter = getPerimeter(combine(leaf_bounds, nodes_[child].bounds));
+				return nodes_[child].isLeaf() ? child_perimeter + inheritance_cost
+				                              : child_perimeter - getPerimeter(nodes_[child].bounds) + inheritance_cost;
+			};
+			const float left_cost = getDescendingCost(node.left);
+			const float right_cost = getDescendingCost(node.right);
+
+			if (cost < left_cost && cost < right_cost)
+				break;
+			sibling = left_cost < right_cost ? node.left : node.right;
+		}
+
+		// The sibling and the leaf share a new parent
+		const ProxyId old_parent = nodes_[sibling].parent;
+		const ProxyId new_parent = allocateNode();
+		nodes_[new_parent].parent = old_parent;
+		nodes_[new_parent].bounds = combine(leaf_bounds, nodes_[sibling].bounds);
+		nodes_[new_parent].height = nodes_[sibling].height + 1;
+		nodes_[new_parent].left = sibling;
+		nodes_[new_parent].right = leaf;
+		nodes_[sibling].parent = new_parent;
+		nodes_[leaf].parent = new_parent;
+
+		if (old_parent == NullProxy)
+			root_ = new_parent;
+		else if (nodes_[old_parent].left == sibling)
+			nodes_[old_parent].left = new_parent;
+		else
+			nodes_[old_parent].right = new_parent;
+
+		refitAncestors(new_parent);
+	}
+
+	void SpatialIndex::removeLeaf(ProxyId leaf)
+	{
+		if (leaf == root_) {
+			root_ = NullProxy;
+			return;
+		}
+
+		// The leaf's sibling replaces their parent
+		const ProxyId parent = nodes_[leaf].parent;
+		const ProxyId grand_parent = nodes_[parent].parent;
+		const ProxyId sibling = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+
+		if (grand_parent == NullProxy) {
+			root_ = sibling;
+			nodes_[sibling].parent = NullProxy;
+		}
+		else {
+			if (nodes_[grand_parent].left == parent)
+				nodes_[grand_parent].left = sibling;
+			else
+				nodes_[grand_parent].right = sibling;
+			nodes_[sibling].parent = grand_parent;
+
+			refitAncestors(grand_parent);
+		}
+		freeNode(parent);
+	}
+
+	void SpatialIndex::refitAncestors(ProxyId id)
+	{
+		while (id != NullProxy) {
+			id = balance(id);
+
+			Node& node = nodes_[id];
+			node.bounds = combine(nodes_[node.left].bounds, nodes_[node.right].bounds);
+			node.height = 1 + std::max(nodes_[node.left].height, nodes_[node.right].height);
+
+			id = node.parent;
+		}
+	}
+
+	SpatialIndex::ProxyId SpatialIndex::balance(ProxyId a)
+	{
+		if (nodes_[a].isLeaf() || nodes_[a].height < 2)
+			return a;
+
+		const ProxyId b = nodes_[a].left;
+		const ProxyId c = nodes_[a].right;
+		const sf::Int32 difference = nodes_[c].height - nodes_[b].height;
+		if (difference >= -1 && difference <= 1)
+			return a;
+
+		// The taller child is promoted to the position of the node
+		const bool rotate_left = difference > 1;
+		const ProxyId up = rotate_left ? c : b;
+		const ProxyId other = rotate_left ? b : c;
+		const ProxyId f = nodes_[up].left;
+		const ProxyId g = nodes_[up].right;
+
+		nodes_[up].left = a;
+		nodes_[up].parent = nodes_[a].parent;
+		nodes_[a].parent = up;
+
+		if (nodes_[up].parent == NullProxy)
+			root_ = up;
+		else if (nodes_[nodes_[up].parent].left == a)
+			nodes_[nodes_[up].parent].left = up;
+		else
+			nodes_[nodes_[up].parent].right = up;
+
+		// The taller grandchild stays under the promoted node, the other one is given to the demoted node
+		const ProxyId kept = nodes_[f].height > nodes_[g].height ? f : g;
+		const ProxyId given = kept == f ? g : f;
+		nodes_[up].right = kept;
+		if (rotate_left) {
+			nodes_[a].left = other;
+			nodes_[a].right = given;
+		}
+		else {
+			nodes_[a].left = given;
+			nodes_[a].right = other;
+		}
+		nodes_[given].parent = a;
+
+		nodes_[a].bounds = combine(nodes_[nodes_[a].left].bounds, nodes_[nodes_[a].right].bounds);
+		nodes_[a].height = 1 + std::max(nodes_[nodes_[a].left].height, nodes_[nodes_[a].right].height);
+		nodes_[up].bounds = combine(nodes_[a].bounds, nodes_[kept].bounds);
+		nodes_[up].height = 1 + std::max(nodes_[a].height, nodes_[kept].height);
+
+		return up;
+	}
+}
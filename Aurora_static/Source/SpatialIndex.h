@@ -0,0 +1,104 @@
+#ifndef Aurora_SpatialIndex_H_
+#define Aurora_SpatialIndex_H_
+
+#include <vector>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+namespace au
+{
+	class MaterialNode;
+
+	/// <summary>
+	/// Broadphase spatial index storing the bounds of material nodes in a dynamic AABB tree<para/>
+	/// Every proxy stores fattened bounds, a proxy is only reinserted once the node's bounds leave them<para/>
+	/// The tree is kept balanced through rotations so that queries remain logarithmic
+	/// </summary>
+	class SpatialIndex : private sf::NonCopyable
+	{
+	public:
+		using ProxyId = sf::Int32;
+		/// <summary>Value used for invalid proxies</summary>
+		static const ProxyId NullProxy = -1;
+
+	public:
+		/// <summary>Constructs the spatial index</summary>
+		/// <param name="margin">The distance by which the bounds of proxies are fattened</param>
+		explicit SpatialIndex(float margin = 16.f);
+	public:
+		/// <summary>Inserts the bounds of a node</summary>
+		/// <param name="bounds">The node's bounds</param>
+		/// <param name="node">The node</param>
+		/// <returns>The proxy's id</returns>
+		/// <see cref="destroyProxy"/>
+		ProxyId createProxy(const sf::FloatRect& bounds, MaterialNode* node);
+		/// <summary>Removes a proxy</summary>
+		/// <param name="proxy">The proxy's id</param>
+		/// <see cref="createProxy"/>
+		void destroyProxy(ProxyId proxy);
+		/// <summary>Updates the bounds of a proxy, it's only reinserted if they left its fattened bounds</summary>
+		/// <param name="proxy">The proxy's id</param>
+		/// <param name="bounds">The node's new bounds</param>
+		/// <returns>True if the proxy was reinserted, false otherwise</returns>
+		bool moveProxy(ProxyId proxy, const sf::FloatRect& bounds);
+		/// <summary>Calls a callback for every proxy whose fattened bounds intersect a rectangle</summary>
+		/// <param name="rect">The rectangle</param>
+		/// <param name="callback">Callable taking the proxy's node (MaterialNode*)</param>
+		template <typename Callback>
+		void query(const sf::FloatRect& rect, Callback callback) const;
+		/// <summary>Returns the node of a proxy</summary>
+		/// <param name="proxy">The proxy's id</param>
+		/// <returns>The proxy's node</returns>
+		inline MaterialNode* getNode(ProxyId proxy) const { return nodes_[proxy].node; }
+		/// <summary>Returns the fattened bounds of a proxy</summary>
+		/// <param name="proxy">The proxy's id</param>
+		/// <returns>The proxy's fattened bounds</returns>
+		inline const sf::FloatRect& getFatBounds(ProxyId proxy) const { return nodes_[proxy].bounds; }
+		/// <summary>Returns the amount of proxies stored</summary>
+		/// <returns>The amount of proxies</returns>
+		inline size_t getProxyCount() const { return proxy_count_; }
+	private:
+		struct Node
+		{
+			sf::FloatRect bounds;
+			MaterialNode* node;
+			ProxyId       parent;   // Next free node while the node is unused
+			ProxyId       left;
+			ProxyId       right;
+			sf::Int32     height;   // -1 while the node is unused, 0 for leaves
+
+			inline bool isLeaf() const { return left == NullProxy; }
+		};
+
+		/// <summary>Retrieves an unused node, the node pool grows if none are available</summary>
+		/// <returns>The node's id</returns>
+		ProxyId allocateNode();
+		/// <summary>Returns a node to the pool</summary>
+		/// <param name="id">The node's id</param>
+		void freeNode(ProxyId id);
+		/// <summary>Inserts a leaf next to the sibling that increases the tree's total perimeter the least</summary>
+		/// <param name="leaf">The leaf's id</param>
+		void insertLeaf(ProxyId leaf);
+		/// <summary>Removes a leaf and its parent from the tree</summary>
+		/// <param name="leaf">The leaf's id</param>
+		void removeLeaf(ProxyId leaf);
+		/// <summary>Refits and rebalances the ancestors of a node up to the root</summary>
+		/// <param name="id">The first ancestor's id</param>
+		void refitAncestors(ProxyId id);
+		/// <summary>Performs a left or right rotation if the node's subtree is imbalanced</summary>
+		/// <param name="id">The node's id</param>
+		/// <returns>The id of the subtree's new root</returns>
+		ProxyId balance(ProxyId id);
+
+	private:
+		std::vector<Node> nodes_;
+		ProxyId           root_;
+		ProxyId           free_list_;
+		size_t            proxy_count_;
+		float             margin_;
+	};
+}
+#include "SpatialIndex.inl"
+#endif
@@ -0,0 +1,32 @@
+namespace au
+{
+	/// <summary>Calls a callback for every proxy whose fattened bounds intersect a rectangle</summary>
+	/// <param name="rect">The rectangle</param>
+	/// <param name="callback">Callable taking the proxy's node (MaterialNode*)</param>
+	template <typename Callback>
+	void SpatialIndex::query(const sf::FloatRect& rect, Callback callback) const
+	{
+		if (root_ == NullProxy)
+			return;
+
+		std::vector<ProxyId> stack;
+		stack.reserve(64);
+		stack.push_back(root_);
+		while (!stack.empty()) {
+			const Node& node = nodes_[stack.back()];
+			stack.pop_back();
+
+			// Touching bounds count as intersecting, unlike sf::Rect::intersects
+			if (node.bounds.left > rect.left + rect.width || rect.left > node.bounds.left + node.bounds.width
+			 || node.bounds.top > rect.top + rect.height || rect.top > node.bounds.top + node.bounds.height)
+				continue;
+
+			if (node.isLeaf())
+				callback(node.node);
+			else {
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+}
@@ -1,4 +1,7 @@
+#include <cstdlib>
+
 #include "SpriteNode.h"
+#include "RenderQueue.h"
 
 namespace au
 {
@@ -25,11 +28,13 @@ namespace au
 	void SpriteNode::setTexture(const sf::Texture& texture)
 	{
 		sprite_.setTexture(texture);
+		invalidateBounds();
 	}
 
 	void SpriteNode::setTextureRect(const sf::FloatRect& rect)
 	{
 		sprite_.setTextureRect(static_cast<sf::IntRect>(rect));
+		invalidateBounds();
 	}
 
 	sf::FloatRect SpriteNode::getLocalBounds() const
@@ -41,4 +46,30 @@ namespace au
 	{
 		target.draw(sprite_, states);
 	}
+
+	void SpriteNode::enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		if (!sprite_.getTexture())
+			return;
+
+		// Same vertices as the ones built by the sf::Sprite
+		const sf::IntRect& rect = sprite_.getTextureRect();
+		const sf::Color& color = sprite_.getColor();
+		const float width = static_cast<float>(std::abs(rect.width));
+		const float height = static_cast<float>(std::abs(rect.height));
+		const float left = static_cast<float>(rect.left);
+		const float right = left + rect.width;
+		const float top = static_cast<float>(rect.top);
+		const float bottom = top + rect.height;
+		const sf::Vertex vertices[] = {
+			sf::Vertex(sf::Vector2f(0.f,   0.f),    color, sf::Vector2f(left,  top)),
+			sf::Vertex(sf::Vector2f(0.f,   height), color, sf::Vector2f(left,  bottom)),
+			sf::Vertex(sf::Vector2f(width, 0.f),    color, sf::Vector2f(right, top)),
+			sf::Vertex(sf::Vector2f(width, height), color, sf::Vector2f(right, bottom))
+		};
+
+		states.transform *= sprite_.getTransform();
+		states.texture = sprite_.getTexture();
+		queue.submit(vertices, 4, sf::TriangleStrip, states, layer);
+	}
 }
\ No newline at end of file
@@ -7,6 +7,7 @@ namespace au
 		: stack_(stack)
 		, window_(window)
 		, window_bounds_(0, 0, window->getSize().x, window->getSize().y)
+		, render_queue_active_(false)
 	{
 	}
 
@@ -34,7 +35,13 @@ namespace au
 
 	void State::draw()
 	{
-		window_->draw(scene_graph_);
+		if (render_queue_active_) {
+			render_queue_.setView(window_->getView());
+			scene_graph_.enqueue(render_queue_);
+			render_queue_.flush(*window_);
+		}
+		else
+			window_->draw(scene_graph_);
 	}
 
 	void State::buildScene()
@@ -4,6 +4,8 @@
 #include <SFML/Graphics/RenderWindow.hpp>
 
 #include "SceneNode.h"
+#include "NodeArena.h"
+#include "RenderQueue.h"
 
 namespace au
 {
@@ -23,6 +25,25 @@ namespace au
 		/// <summary>Reinitializes the window bounds (for when the window is recreated)</summary>
 		void reinitializeWindowBounds();
 		/// <summary>
+		/// (De)Activates drawing the scene graph through a render queue in the default draw method<para/>
+		/// Draw items sharing the same render states are then merged into fewer draw calls
+		/// </summary>
+		/// <param name="flag">True to activate, false to deactivate</param>
+		/// <see cref="getRenderQueueStats"/>
+		inline void activateRenderQueue(bool flag) { render_queue_active_ = flag; }
+		/// <summary>Returns the draw call statistics of the last frame drawn through the render queue</summary>
+		/// <returns>The render queue's statistics</returns>
+		/// <see cref="activateRenderQueue"/>
+		inline const RenderQueue::Stats& getRenderQueueStats() const { return render_queue_.getStats(); }
+		/// <summary>
+		/// Creates a scene node allocated from the state's node arena<para/>
+		/// The arena's memory is released in bulk once the state and all of its nodes are destroyed
+		/// </summary>
+		/// <param name="args">The arguments passed to the node's constructor</param>
+		/// <returns>The created node</returns>
+		template <typename T, typename... Args>
+		inline std::unique_ptr<T> createNode(Args&&... args) { return node_arena_.create<T>(std::forward<Args>(args)...); }
+		/// <summary>
 		/// Handles the polled input event<para/>
 		/// Defined by the user
 		/// </summary>
@@ -63,9 +84,12 @@ namespace au
 		StateStack*             stack_;
 		sf::RenderWindow*       window_;
 
+		NodeArena               node_arena_;
 		SceneNode               scene_graph_;
 		std::vector<SceneNode*> scene_layers_;
 		sf::IntRect             window_bounds_;
+		RenderQueue             render_queue_;
+		bool                    render_queue_active_;
 	};
 }
 #endif
\ No newline at end of file
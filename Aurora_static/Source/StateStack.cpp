@@ -2,6 +2,7 @@
 
 #include "StateStack.h"
 #include "Application.h"
+#include "Profiler.h"
 
 namespace au
 {
@@ -19,6 +20,8 @@ namespace au
 
 	void StateStack::handleEvent(const sf::Event& event)
 	{
+		AU_PROFILE_SCOPE("StateStack::handleEvent", "state stack");
+
 		for (auto itr = stack_.rbegin(); itr != stack_.rend(); ++itr)
 			if (!(*itr).second->handleEvent(event))
 				break;
@@ -28,6 +31,8 @@ namespace au
 
 	void StateStack::update(sf::Time dt)
 	{
+		AU_PROFILE_SCOPE("StateStack::update", "state stack");
+
 		for (auto itr = stack_.rbegin(); itr != stack_.rend(); ++itr)
 			if (!(*itr).second->update(dt))
 				break;
@@ -37,6 +42,8 @@ namespace au
 
 	void StateStack::draw()
 	{
+		AU_PROFILE_SCOPE("StateStack::draw", "state stack");
+
 		for (const auto& state : stack_)
 			state.second->draw();
 	}
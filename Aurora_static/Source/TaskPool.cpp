@@ -0,0 +1,142 @@
+#include <algorithm>
+
+#include "TaskPool.h"
+
+namespace au
+{
+	thread_local TaskPool* TaskPool::current_pool_ = nullptr;
+	thread_local unsigned TaskPool::current_queue_ = 0;
+
+	TaskPool::Group::Group()
+		: pending_tasks_(0)
+		, exception_(nullptr)
+	{
+	}
+
+	TaskPool::TaskPool(unsigned worker_count)
+		: queued_tasks_(0)
+		, running_(true)
+	{
+		for (unsigned i = 0; i <= worker_count; ++i)
+			queues_.emplace_back(std::make_unique<Queue>());
+		for (unsigned i = 0; i < worker_count; ++i)
+			threads_.emplace_back(&TaskPool::work, this, i);
+	}
+
+	TaskPool::~TaskPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+			running_ = false;
+		}
+		wake_condition_.notify_all();
+
+		for (std::thread& thread : threads_)
+			thread.join();
+	}
+
+	void TaskPool::submit(Group& group, Task task)
+	{
+		group.pending_tasks_.fetch_add(1, std::memory_order_relaxed);
+
+		Queue& queue = *queues_[current_pool_ == this ? current_queue_ : queues_.size() - 1];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.entries.push_back({ std::move(task), &group });
+		}
+		queued_tasks_.fetch_add(1, std::memory_order_release);
+
+		// Locking prevents the notification from being lost between a worker's check and its wait
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+		wake_condition_.notify_one();
+	}
+
+	void TaskPool::wait(Group& group)
+	{
+		Entry entry;
+		while (group.pending_tasks_.load(std::memory_order_acquire) > 0) {
+			if (acquire(entry))
+				execute(entry);
+			else
+				std::this_thread::yield();
+		}
+
+		if (group.exception_) {
+			std::exception_ptr exception = group.exception_;
+			group.exception_ = nullptr;
+			std::rethrow_exception(exception);
+		}
+	}
+
+	TaskPool& TaskPool::getDefault()
+	{
+		static TaskPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+		return pool;
+	}
+
+	void TaskPool::work(unsigned index)
+	{
+		current_pool_ = this;
+		current_queue_ = index;
+
+		Entry entry;
+		while (true) {
+			if (acquire(entry))
+				execute(entry);
+			else {
+				std::unique_lock<std::mutex> lock(sleep_mutex_);
+				wake_condition_.wait(lock, [this]() {
+					return !running_ || queued_tasks_.load(std::memory_order_acquire) > 0;
+				});
+				if (!running_ && queued_tasks_.load(std::memory_order_acquire) == 0)
+					return;
+			}
+		}
+	}
+
+	bool TaskPool::acquire(Entry& entry)
+	{
+		const size_t external_queue = queues_.size() - 1;
+		const size_t own_queue = current_pool_ == this ? current_queue_ : external_queue;
+
+		// The most recent task of a worker's own queue is likely to still be in its cache
+		if (own_queue != external_queue) {
+			Queue& queue = *queues_[own_queue];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.entries.empty()) {
+				entry = std::move(queue.entries.back());
+				queue.entries.pop_back();
+				queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		// The oldest tasks of the other queues are stolen, they're usually the largest ones
+		for (size_t i = 1; i <= queues_.size(); ++i) {
+			Queue& queue = *queues_[(own_queue + i) % queues_.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.entries.empty()) {
+				entry = std::move(queue.entries.front());
+				queue.entries.pop_front();
+				queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void TaskPool::execute(Entry& entry)
+	{
+		try {
+			entry.task();
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(entry.group->exception_mutex_);
+			if (!entry.group->exception_)
+				entry.group->exception_ = std::current_exception();
+		}
+
+		entry.task = nullptr;
+		entry.group->pending_tasks_.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
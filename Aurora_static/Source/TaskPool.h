@@ -0,0 +1,104 @@
+#ifndef Aurora_TaskPool_H_
+#define Aurora_TaskPool_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <SFML/System/NonCopyable.hpp>
+
+namespace au
+{
+	/// <summary>
+	/// Work-stealing pool of worker threads<para/>
+	/// Every worker owns a task queue, tasks submitted by a worker are pushed onto its own queue<para/>
+	/// and idle workers steal tasks from the other queues<para/>
+	/// Threads waiting on a group of tasks help executing queued tasks instead of blocking
+	/// </summary>
+	class TaskPool : private sf::NonCopyable
+	{
+	public:
+		using Task = std::function<void()>;
+
+		/// <summary>Set of submitted tasks that can be waited on</summary>
+		class Group : private sf::NonCopyable
+		{
+		public:
+			/// <summary>Default constructor</summary>
+			Group();
+		private:
+			std::atomic<size_t> pending_tasks_;
+			std::exception_ptr  exception_;
+			std::mutex          exception_mutex_;
+
+			friend class TaskPool;
+		};
+
+	public:
+		/// <summary>Constructs the pool and launches its worker threads</summary>
+		/// <param name="worker_count">The amount of worker threads (the waiting threads also execute tasks)</param>
+		explicit TaskPool(unsigned worker_count);
+		/// <summary>Finishes the queued tasks and joins the worker threads</summary>
+		~TaskPool();
+	public:
+		/// <summary>Queues a task for execution</summary>
+		/// <param name="group">The group the task belongs to</param>
+		/// <param name="task">The task, it mustn't outlive the data it references</param>
+		/// <see cref="wait"/>
+		void submit(Group& group, Task task);
+		/// <summary>
+		/// Executes queued tasks until all of the group's tasks are finished<para/>
+		/// The first exception thrown by one of the group's tasks is rethrown
+		/// </summary>
+		/// <param name="group">The group to wait on</param>
+		/// <see cref="submit"/>
+		void wait(Group& group);
+		/// <summary>Returns the amount of worker threads</summary>
+		/// <returns>The amount of worker threads</returns>
+		inline unsigned getWorkerCount() const { return static_cast<unsigned>(threads_.size()); }
+		/// <summary>Returns the pool shared by the engine, it uses one worker less than the hardware threads</summary>
+		/// <returns>The default pool</returns>
+		static TaskPool& getDefault();
+	private:
+		struct Entry
+		{
+			Task   task;
+			Group* group;
+		};
+		struct Queue
+		{
+			std::mutex        mutex;
+			std::deque<Entry> entries;
+		};
+
+		/// <summary>Main loop of the worker threads</summary>
+		/// <param name="index">Index of the worker's queue</param>
+		void work(unsigned index);
+		/// <summary>Pops a task from the calling thread's queue or steals one from the other queues</summary>
+		/// <param name="entry">Receives the task</param>
+		/// <returns>True if a task was retrieved, false if all the queues are empty</returns>
+		bool acquire(Entry& entry);
+		/// <summary>Executes a task and informs its group</summary>
+		/// <param name="entry">The task</param>
+		void execute(Entry& entry);
+
+	private:
+		// The last queue receives the tasks submitted from outside of the pool
+		std::vector<std::unique_ptr<Queue>> queues_;
+		std::vector<std::thread>            threads_;
+		std::atomic<size_t>                 queued_tasks_;
+		std::mutex                          sleep_mutex_;
+		std::condition_variable             wake_condition_;
+		bool                                running_;
+
+		static thread_local TaskPool*       current_pool_;
+		static thread_local unsigned        current_queue_;
+	};
+}
+#endif
@@ -82,6 +82,7 @@ namespace au
 	void Text::setOutlineThickness(float thickness)
 	{
 		text_.setOutlineThickness(thickness);
+		invalidateBounds();
 	}
 
 	sf::Vector2f Text::findCharacterPos(size_t index) const
@@ -1,6 +1,7 @@
 #include <SFML/Graphics/Texture.hpp>
 
 #include "VertexNode.h"
+#include "RenderQueue.h"
 
 namespace au
 {
@@ -68,6 +69,7 @@ namespace au
 			vertices_[i].position.x = size.x * vertices_[i].position.x / current_size.x;
 			vertices_[i].position.y = size.y * vertices_[i].position.y / current_size.y;
 		}
+		invalidateBounds();
 	}
 
 	void VertexNode::setTexture(const sf::Texture& texture)
@@ -123,4 +125,12 @@ namespace au
 		states.texture = texture_;
 		target.draw(vertices_, states);
 	}
+
+	void VertexNode::enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const
+	{
+		if (vertices_.getVertexCount() > 0) {
+			states.texture = texture_;
+			queue.submit(&vertices_[0], vertices_.getVertexCount(), vertices_.getPrimitiveType(), states, layer);
+		}
+	}
 }
\ No newline at end of file
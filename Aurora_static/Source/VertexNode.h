@@ -85,6 +85,11 @@ namespace au
 		/// <param name="target">Render target (window, render texture)</param>
 		/// <param name="states">Render states (transform, texture)</param>
 		virtual void drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const override;
+		/// <summary>Submits the node's vertices to the render queue</summary>
+		/// <param name="queue">The render queue</param>
+		/// <param name="states">Render states (transform, texture)</param>
+		/// <param name="layer">The node's render layer</param>
+		virtual void enqueueCurrent(RenderQueue& queue, sf::RenderStates states, int layer) const override;
 
 	private:
 		sf::VertexArray    vertices_;
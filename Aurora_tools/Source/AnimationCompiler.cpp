@@ -0,0 +1,58 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include <AnimationArchive.h>
+#include <AnimationAtlas.h>
+
+namespace
+{
+	void printUsage(const char* program)
+	{
+		std::cerr << "Usage: " << program << " input.json output.auanim [--once name] [--loopback name]\n"
+		          << "Compiles the animations of a TexturePacker JSON atlas, animations repeat unless they're listed with --once\n"
+		          << "and the ones listed with --loopback also play back in reverse\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3) {
+		printUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const std::string input(argv[1]);
+	const std::string output(argv[2]);
+	std::unordered_map<std::string, sf::Uint32> flags;
+	for (int i = 3; i < argc; ++i) {
+		const std::string argument(argv[i]);
+		if (i + 1 >= argc) {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+
+		const std::string name(argv[++i]);
+		auto inserted = flags.insert(std::make_pair(name, au::AnimationArchive::Repeat));
+		if (argument == "--once")
+			inserted.first->second &= ~au::AnimationArchive::Repeat;
+		else if (argument == "--loopback")
+			inserted.first->second |= au::AnimationArchive::Loopback;
+		else {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	au::AnimationAtlas atlas;
+	if (!atlas.loadFromFile(input) || !au::AnimationArchive::compile(atlas, output, au::AnimationArchive::Repeat, flags))
+		return EXIT_FAILURE;
+
+	au::AnimationArchive archive;
+	if (!archive.openFromFile(output))
+		return EXIT_FAILURE;
+	std::cerr << "Compiled " << archive.getAnimationCount() << " animations of " << atlas.getRegionCount()
+	          << " frames into " << output << '\n';
+	return EXIT_SUCCESS;
+}